@@ -122,6 +122,7 @@ void CompareDialog::on_printButton_clicked()
   dialog->setWindowTitle(tr("Print Document"));
   if (dialog->exec() != QDialog::Accepted)
     return;
+  multimodelprinter.waitForCurves();
   ui->textEdit->print(&printer);
 }
 
@@ -137,6 +138,7 @@ void CompareDialog::on_printFileButton_clicked()
     if (QFileInfo(filename).suffix().isEmpty())
       filename.append(".pdf");
     printer.setOutputFileName(filename);
+    multimodelprinter.waitForCurves();
     ui->textEdit->print(&printer);
   }
 }
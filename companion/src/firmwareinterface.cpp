@@ -26,6 +26,98 @@
 #define TIME_MARK   "TIME"
 #define EEPR_MARK   "EEPR"
 
+/*
+ * Finds a set of signatures in a single pass over the firmware image.
+ * Each signature is anchored on its rarest pair of consecutive bytes in this
+ * image, which avoids the long runs of 0x00 or 0xFF at the start of most of
+ * them. Candidates are selected on their anchor with a lookup table, only
+ * those are then compared with memcmp.
+ * As with QByteArray::indexOf() in the previous implementation, a match
+ * at offset 0 is never reported.
+ */
+class SignatureScanner
+{
+  public:
+    int add(const QByteArray & signature, bool allMatches=false)
+    {
+      int id = signatures.size();
+      signatures.append(signature);
+      multiple.append(allMatches);
+      matches.append(QList<int>());
+      anchors.append(0);
+      return id;
+    }
+
+    void scan(const QByteArray & data)
+    {
+      const char * start = data.constData();
+      int size = data.size();
+
+      // the frequency of each byte value in the image, the frequency of a pair is estimated from it
+      QVector<quint64> frequencies(256, 0);
+      for (int i=0; i<size; i++) {
+        frequencies[(quint8)start[i]]++;
+      }
+
+      QVector<bool> prefixes(0x10000, false);
+      QMultiHash<quint16, int> candidates;
+      for (int id=0; id<signatures.size(); id++) {
+        const char * signature = signatures[id].constData();
+        quint64 best = ~(quint64)0;
+        for (int k=0; k<signatures[id].size()-1; k++) {
+          quint64 frequency = frequencies[(quint8)signature[k]] * frequencies[(quint8)signature[k+1]];
+          if (frequency < best) {
+            best = frequency;
+            anchors[id] = k;
+          }
+        }
+        quint16 prefix = getPrefix(signature + anchors[id]);
+        prefixes[prefix] = true;
+        candidates.insert(prefix, id);
+      }
+
+      for (int i=1; i<size-1; i++) {
+        quint16 prefix = getPrefix(start + i);
+        if (!prefixes[prefix])
+          continue;
+        for (QMultiHash<quint16, int>::const_iterator it = candidates.constFind(prefix); it != candidates.constEnd() && it.key() == prefix; ++it) {
+          int id = it.value();
+          const QByteArray & signature = signatures[id];
+          int position = i - anchors[id];
+          if (position > 0 && (multiple[id] || matches[id].isEmpty()) && position + signature.size() <= size && !memcmp(start + position, signature.constData(), signature.size())) {
+            matches[id].append(position);
+          }
+        }
+      }
+    }
+
+    int first(int id) const
+    {
+      return matches[id].isEmpty() ? -1 : matches[id].first();
+    }
+
+    const QList<int> & all(int id) const
+    {
+      return matches[id];
+    }
+
+    const QByteArray & signature(int id) const
+    {
+      return signatures[id];
+    }
+
+  protected:
+    static quint16 getPrefix(const char * data)
+    {
+      return ((quint8)data[0] << 8) + (quint8)data[1];
+    }
+
+    QList<QByteArray> signatures;
+    QList<bool> multiple;
+    QList<int> anchors;
+    QList< QList<int> > matches;
+};
+
 int getFileType(const QString &fullFileName)
 {
   QString suffix = QFileInfo(fullFileName).suffix().toUpper();
@@ -43,6 +135,43 @@ int getFileType(const QString &fullFileName)
     return 0;
 }
 
+#define OTX_SPS_9X      "SPS\0\200\100"
+#define OTX_SPS_TARANIS "SPS\0\324\100"
+#define OTX_SPS_SIZE    6
+#define OTX_SPE         "SPE"
+#define OTX_SPE_SIZE    4
+
+struct SplashSignatures {
+  int gr9x;
+  int gr9xv4;
+  int er9x;
+  int opentx;
+  int opentxTaranis;
+  int ersky9x;
+  int otxSps9x;
+  int otxSpsTaranis;
+  int otxSpe;
+  int ersky9xSps;
+  int ersky9xSpe;
+  int erMarker;
+};
+
+static void addSplashSignatures(SignatureScanner & scanner, SplashSignatures & splashes)
+{
+  splashes.gr9x = scanner.add(QByteArray((const char *)gr9x_splash, sizeof(gr9x_splash)));
+  splashes.gr9xv4 = scanner.add(QByteArray((const char *)gr9xv4_splash, sizeof(gr9xv4_splash)));
+  splashes.er9x = scanner.add(QByteArray((const char *)er9x_splash, sizeof(er9x_splash)));
+  splashes.opentx = scanner.add(QByteArray((const char *)opentx_splash, sizeof(opentx_splash)));
+  splashes.opentxTaranis = scanner.add(QByteArray((const char *)opentxtaranis_splash, sizeof(opentxtaranis_splash)));
+  splashes.ersky9x = scanner.add(QByteArray((const char *)ersky9x_splash, sizeof(ersky9x_splash)));
+  splashes.otxSps9x = scanner.add(QByteArray(OTX_SPS_9X, OTX_SPS_SIZE), true);
+  splashes.otxSpsTaranis = scanner.add(QByteArray(OTX_SPS_TARANIS, OTX_SPS_SIZE), true);
+  splashes.otxSpe = scanner.add(QByteArray(OTX_SPE, OTX_SPE_SIZE));
+  splashes.ersky9xSps = scanner.add(QByteArray(ERSKY9X_SPS, sizeof(ERSKY9X_SPS)), true);
+  splashes.ersky9xSpe = scanner.add(QByteArray(ERSKY9X_SPE, sizeof(ERSKY9X_SPE)));
+  splashes.erMarker = scanner.add(QByteArray(ERSPLASH_MARKER, sizeof(ERSPLASH_MARKER)));
+}
+
 FirmwareInterface::FirmwareInterface(const QString &filename):
   flash(MAX_FSIZE, 0),
   flashSize(0),
@@ -57,7 +186,12 @@ FirmwareInterface::FirmwareInterface(const QString &filename):
 {
   if (!filename.isEmpty()) {
     QFile file(filename);
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) { // reading HEX TEXT file
+    if (getFileType(filename) == FILE_TYPE_BIN) {
+      if (file.open(QIODevice::ReadOnly)) {
+        flashSize = file.read((char *)flash.data(), MAX_FSIZE);
+      }
+    }
+    else if (file.open(QIODevice::ReadOnly | QIODevice::Text)) { // reading HEX TEXT file
       QTextStream inputStream(&file);
       flashSize = HexInterface(inputStream).load((uint8_t *)flash.data(), MAX_FSIZE);
       file.close();
@@ -69,17 +203,28 @@ FirmwareInterface::FirmwareInterface(const QString &filename):
   }
 
   if (flashSize > 0) {
-    flavour = seekLabel(FW_MARK);
-    version = seekLabel(VERS_MARK);
+    SignatureScanner scanner;
+    int labels[5][2];
+    const char * marks[5] = { FW_MARK, VERS_MARK, DATE_MARK, TIME_MARK, EEPR_MARK };
+    for (int i=0; i<5; i++) {
+      labels[i][0] = scanner.add(QByteArray(marks[i]) + "\037\033:");
+      labels[i][1] = scanner.add(QByteArray(marks[i]) + ":");
+    }
+    SplashSignatures splashes;
+    addSplashSignatures(scanner, splashes);
+    scanner.scan(flash);
+
+    flavour = seekLabel(scanner, labels[0]);
+    version = seekLabel(scanner, labels[1]);
     if (version.startsWith("opentx-")) {
       // old version format
       int index = version.lastIndexOf('-');
       flavour = version.mid(0, index);
       version = version.mid(index+1);
     }
-    date = seekLabel(DATE_MARK);
-    time = seekLabel(TIME_MARK);
-    eepromId = seekLabel(EEPR_MARK);
+    date = seekLabel(scanner, labels[2]);
+    time = seekLabel(scanner, labels[3]);
+    eepromId = seekLabel(scanner, labels[4]);
 
     if (eepromId.contains('-')) {
       QStringList list = eepromId.split('-');
@@ -91,18 +236,17 @@ FirmwareInterface::FirmwareInterface(const QString &filename):
     }
 
     versionId = version2index(version);
-    SeekSplash();
+    SeekSplash(scanner, splashes);
     isValidFlag = !version.isEmpty();
   }
 }
 
-QString FirmwareInterface::seekString(const QString & string)
+QString FirmwareInterface::seekString(int start, int length)
 {
   QString result = "";
 
-  int start = flash.indexOf(string);
   if (start > 0) {
-    start += string.length();
+    start += length;
     int end = -1;
     for (int i=start; i<start+50; i++) {
       char c = flash.at(i);
@@ -119,13 +263,13 @@ QString FirmwareInterface::seekString(const QString & string)
   return result;
 }
 
-QString FirmwareInterface::seekLabel(const QString & label)
+QString FirmwareInterface::seekLabel(const SignatureScanner & scanner, const int ids[2])
 {
-  QString result = seekString(label + "\037\033:");
+  QString result = seekString(scanner.first(ids[0]), scanner.signature(ids[0]).size());
   if (!result.isEmpty())
     return result;
 
-  return seekString(label + ":");
+  return seekString(scanner.first(ids[1]), scanner.signature(ids[1]).size());
 }
 
 QString FirmwareInterface::getFlavour() const
@@ -151,12 +295,12 @@ bool FirmwareInterface::isHardwareCompatible(const FirmwareInterface &previousFi
   return (newFlavour == previousFlavour);
 }
 
-bool FirmwareInterface::SeekSplash(QByteArray splash)
+bool FirmwareInterface::SeekSplash(const SignatureScanner & scanner, int splash)
 {
-  int start = flash.indexOf(splash);
+  int start = scanner.first(splash);
   if (start>0) {
     splashOffset = start;
-    splashSize = splash.size();
+    splashSize = scanner.signature(splash).size();
     return true;
   }
   else {
@@ -164,33 +308,22 @@ bool FirmwareInterface::SeekSplash(QByteArray splash)
   }
 }
 
-bool FirmwareInterface::SeekSplash(QByteArray sps, QByteArray spe, int size)
+bool FirmwareInterface::SeekSplash(const SignatureScanner & scanner, int sps, int spe, int size)
 {
-  int start = 0;
-  while (start>=0) {
-    start = flash.indexOf(sps, start+1);
-    if (start>0) {
-      int end = start + sps.size() + size;
-      if (end == flash.indexOf(spe, end)) {
-        splashOffset = start + sps.size();
-        splashSize = end - start - sps.size();
-        return true;
-      }
-      else {
-        qDebug() << flash.indexOf(spe, start) << end << sps.size() << spe;
-      }
+  const QByteArray & spsSignature = scanner.signature(sps);
+  const QByteArray & speSignature = scanner.signature(spe);
+  foreach (int start, scanner.all(sps)) {
+    int end = start + spsSignature.size() + size;
+    if (end + speSignature.size() <= flash.size() && !memcmp(flash.constData() + end, speSignature.constData(), speSignature.size())) {
+      splashOffset = start + spsSignature.size();
+      splashSize = end - start - spsSignature.size();
+      return true;
     }
   }
   return false;
 }
 
-#define OTX_SPS_9X      "SPS\0\200\100"
-#define OTX_SPS_TARANIS "SPS\0\324\100"
-#define OTX_SPS_SIZE    6
-#define OTX_SPE         "SPE"
-#define OTX_SPE_SIZE    4
-
-void FirmwareInterface::SeekSplash(void) 
+void FirmwareInterface::SeekSplash(const SignatureScanner & scanner, const SplashSignatures & splashes)
 {
   splashSize = 0;
   splashOffset = 0;
@@ -198,45 +331,45 @@ void FirmwareInterface::SeekSplash(void)
   splashHeight = SPLASH_HEIGHT;
   splash_format = QImage::Format_Mono;
 
-  if (SeekSplash(QByteArray((const char *)gr9x_splash, sizeof(gr9x_splash))) || SeekSplash(QByteArray((const char *)gr9xv4_splash, sizeof(gr9xv4_splash)))) {
+  if (SeekSplash(scanner, splashes.gr9x) || SeekSplash(scanner, splashes.gr9xv4)) {
     return;
   }
 
-  if (SeekSplash(QByteArray((const char *)er9x_splash, sizeof(er9x_splash)))) {
+  if (SeekSplash(scanner, splashes.er9x)) {
     return;
   }
 
-  if (SeekSplash(QByteArray((const char *)opentx_splash, sizeof(opentx_splash)))) {
+  if (SeekSplash(scanner, splashes.opentx)) {
     return;
   }
 
-  if (SeekSplash(QByteArray((const char *)opentxtaranis_splash, sizeof(opentxtaranis_splash)))) {
+  if (SeekSplash(scanner, splashes.opentxTaranis)) {
     splashWidth = SPLASHX9D_WIDTH;
     splashHeight = SPLASHX9D_HEIGHT;
     splash_format = QImage::Format_Indexed8;
     return;
   }
 
-  if (SeekSplash(QByteArray((const char *)ersky9x_splash, sizeof(ersky9x_splash)))) {
+  if (SeekSplash(scanner, splashes.ersky9x)) {
     return;
   }
 
-  if (SeekSplash(QByteArray(OTX_SPS_9X, OTX_SPS_SIZE), QByteArray(OTX_SPE, OTX_SPE_SIZE), 1024)) {
+  if (SeekSplash(scanner, splashes.otxSps9x, splashes.otxSpe, 1024)) {
     return;
   }
 
-  if (SeekSplash(QByteArray(OTX_SPS_TARANIS, OTX_SPS_SIZE), QByteArray(OTX_SPE, OTX_SPE_SIZE), 6784)) {
+  if (SeekSplash(scanner, splashes.otxSpsTaranis, splashes.otxSpe, 6784)) {
     splashWidth = SPLASHX9D_WIDTH;
     splashHeight = SPLASHX9D_HEIGHT;
     splash_format = QImage::Format_Indexed8;
     return;
   }
 
-  if (SeekSplash(QByteArray(ERSKY9X_SPS, sizeof(ERSKY9X_SPS)), QByteArray(ERSKY9X_SPE, sizeof(ERSKY9X_SPE)), 1030)) {
+  if (SeekSplash(scanner, splashes.ersky9xSps, splashes.ersky9xSpe, 1030)) {
     return;
   }
 
-  if (SeekSplash(QByteArray(ERSPLASH_MARKER, sizeof(ERSPLASH_MARKER)))) {
+  if (SeekSplash(scanner, splashes.erMarker)) {
     splashOffset += sizeof(ERSPLASH_MARKER);
     splashSize = sizeof(er9x_splash);
   }
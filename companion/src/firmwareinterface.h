@@ -39,6 +39,9 @@
 
 int getFileType(const QString &fullFileName);
 
+class SignatureScanner;
+struct SplashSignatures;
+
 class FirmwareInterface
 {
   public:
@@ -65,11 +68,11 @@ class FirmwareInterface
   private:
     QByteArray flash;
     uint flashSize;
-    QString seekString(const QString & string);
-    QString seekLabel(const QString & label);
-    void SeekSplash();
-    bool SeekSplash(QByteArray sps, QByteArray spe, int size);
-    bool SeekSplash(QByteArray splash);
+    QString seekString(int start, int length);
+    QString seekLabel(const SignatureScanner & scanner, const int ids[2]);
+    void SeekSplash(const SignatureScanner & scanner, const SplashSignatures & splashes);
+    bool SeekSplash(const SignatureScanner & scanner, int sps, int spe, int size);
+    bool SeekSplash(const SignatureScanner & scanner, int splash);
     QString filename;
     QString date;
     QString time;
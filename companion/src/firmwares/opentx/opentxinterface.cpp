@@ -43,12 +43,14 @@ size_t SizeOfArray( T(&)[ N ] )
 
 OpenTxEepromInterface::OpenTxEepromInterface(BoardEnum board):
   EEPROMInterface(board),
-  efile(new RleFile())
+  efile(new RleFile()),
+  sizeCacheVariant(0)
 {
 }
 
 OpenTxEepromInterface::~OpenTxEepromInterface()
 {
+  clearSizeCache();
   delete efile;
 }
 
@@ -462,6 +464,46 @@ int OpenTxEepromInterface::save(uint8_t *eeprom, RadioData &radioData, uint32_t
   return size;
 }
 
+// The RLC2 compression runs over the whole exported file, so the size of a
+// model cannot be summed from its sections. Instead the field tree of each
+// structure is built once and kept: it is bound to the structure address and
+// reads its current content on each export. Only an export which differs from
+// the previous one is compressed again.
+int OpenTxEepromInterface::getCachedSize(SizeCacheEntry & entry, uint8_t fileType)
+{
+  QByteArray data;
+  entry.fields->Export(data);
+  if (data == entry.data) {
+    return entry.size;
+  }
+
+  if (sizeBuffer.size() != EESIZE_MAX) {
+    sizeBuffer.resize(EESIZE_MAX);
+  }
+  sizeBuffer.fill(0);
+  efile->EeFsCreate((uint8_t *)sizeBuffer.data(), EESIZE_MAX, board, 255/*version max*/);
+
+  entry.size = -1;
+  int sz = efile->writeRlc2(0, fileType, (const uint8_t*)data.constData(), data.size());
+  if (sz == data.size()) {
+    entry.size = efile->size(0);
+  }
+  entry.data = data;
+  return entry.size;
+}
+
+void OpenTxEepromInterface::clearSizeCache()
+{
+  foreach (const SizeCacheEntry & entry, modelsSizeCache) {
+    delete entry.fields;
+  }
+  modelsSizeCache.clear();
+  foreach (const SizeCacheEntry & entry, generalSizeCache) {
+    delete entry.fields;
+  }
+  generalSizeCache.clear();
+}
+
 int OpenTxEepromInterface::getSize(const ModelData & model)
 {
   if (IS_SKY9X(board))
@@ -470,18 +512,18 @@ int OpenTxEepromInterface::getSize(const ModelData & model)
   if (model.isEmpty())
     return 0;
 
-  QByteArray tmp(EESIZE_MAX, 0);
-  efile->EeFsCreate((uint8_t *)tmp.data(), EESIZE_MAX, board, 255/*version max*/);
-
-  OpenTxModelData open9xModel((ModelData &)model, board, 255/*version max*/, GetCurrentFirmware()->getVariantNumber());
+  unsigned int variant = GetCurrentFirmware()->getVariantNumber();
+  if (variant != sizeCacheVariant || modelsSizeCache.size() >= 256) {
+    clearSizeCache();
+    sizeCacheVariant = variant;
+  }
 
-  QByteArray eeprom;
-  open9xModel.Export(eeprom);
-  int sz = efile->writeRlc2(0, FILE_TYP_MODEL, (const uint8_t*)eeprom.constData(), eeprom.size());
-  if (sz != eeprom.size()) {
-    return -1;
+  QHash<const ModelData *, SizeCacheEntry>::iterator it = modelsSizeCache.find(&model);
+  if (it == modelsSizeCache.end()) {
+    SizeCacheEntry entry = { new OpenTxModelData((ModelData &)model, board, 255/*version max*/, variant), QByteArray(), -1 };
+    it = modelsSizeCache.insert(&model, entry);
   }
-  return efile->size(0);
+  return getCachedSize(it.value(), FILE_TYP_MODEL);
 }
 
 int OpenTxEepromInterface::getSize(const GeneralSettings & settings)
@@ -489,19 +531,18 @@ int OpenTxEepromInterface::getSize(const GeneralSettings & settings)
   if (IS_SKY9X(board))
     return 0;
 
-  QByteArray tmp(EESIZE_MAX, 0);
-  efile->EeFsCreate((uint8_t *)tmp.data(), EESIZE_MAX, board, 255);
-
-  OpenTxGeneralData open9xGeneral((GeneralSettings &)settings, board, 255, GetCurrentFirmware()->getVariantNumber());
-  // open9xGeneral.Dump();
+  unsigned int variant = GetCurrentFirmware()->getVariantNumber();
+  if (variant != sizeCacheVariant || generalSizeCache.size() >= 16) {
+    clearSizeCache();
+    sizeCacheVariant = variant;
+  }
 
-  QByteArray eeprom;
-  open9xGeneral.Export(eeprom);
-  int sz = efile->writeRlc2(0, FILE_TYP_GENERAL, (const uint8_t*)eeprom.constData(), eeprom.size());
-  if (sz != eeprom.size()) {
-    return -1;
+  QHash<const GeneralSettings *, SizeCacheEntry>::iterator it = generalSizeCache.find(&settings);
+  if (it == generalSizeCache.end()) {
+    SizeCacheEntry entry = { new OpenTxGeneralData((GeneralSettings &)settings, board, 255, variant), QByteArray(), -1 };
+    it = generalSizeCache.insert(&settings, entry);
   }
-  return efile->size(0);
+  return getCachedSize(it.value(), FILE_TYP_GENERAL);
 }
 
 Firmware * OpenTxFirmware::getFirmwareVariant(const QString & id)
@@ -17,9 +17,11 @@
 #ifndef opentx_interface_h
 #define opentx_interface_h
 
+#include <QHash>
 #include "eeprominterface.h"
 
 class RleFile;
+class DataField;
 
 class OpenTxEepromInterface : public EEPROMInterface
 {
@@ -70,8 +72,27 @@ class OpenTxEepromInterface : public EEPROMInterface
     template <class T>
     bool saveGeneral(GeneralSettings &settings, BoardEnum board, uint32_t version, uint32_t variant);
 
+    // The field tree of a cached structure, bound to its address, and its last export
+    struct SizeCacheEntry {
+      DataField * fields;
+      QByteArray data;
+      int size;
+    };
+
+    int getCachedSize(SizeCacheEntry & entry, uint8_t fileType);
+
+    void clearSizeCache();
+
     RleFile *efile;
 
+    QByteArray sizeBuffer;
+
+    QHash<const ModelData *, SizeCacheEntry> modelsSizeCache;
+
+    QHash<const GeneralSettings *, SizeCacheEntry> generalSizeCache;
+
+    unsigned int sizeCacheVariant;
+
 };
 
 class OpenTxFirmware: public Firmware {
@@ -362,7 +362,8 @@ void delay_01us(::uint16_t nb)
 {
 }
 
-OpenTxSimulator::OpenTxSimulator()
+OpenTxSimulator::OpenTxSimulator():
+  lockstep(false)
 {
 }
 
@@ -391,7 +392,7 @@ bool OpenTxSimulator::timer10ms()
 #include "simulatorimport.h"
 }
 
-bool OpenTxSimulator::lcdChanged(bool & lightEnable)
+bool OpenTxSimulator::lcdChanged(bool & lightEnable, int & firstRow, int & lastRow)
 {
 #define LCDCHANGED_IMPORT
 #include "simulatorimport.h"
@@ -417,8 +418,36 @@ void OpenTxSimulator::start(const char * filename, bool tests)
   StartMainThread(tests);
 }
 
+bool OpenTxSimulator::startLockstep(QByteArray & eeprom)
+{
+  memcpy(NAMESPACE::eeprom, eeprom.data(), std::min<int>(sizeof(NAMESPACE::eeprom), eeprom.size()));
+
+#if defined(PCBSKY9X) && !defined(REVX)
+  g_rotenc[0] = 0;
+#elif defined(PCBGRUVIN9X)
+  g_rotenc[0] = 0;
+  g_rotenc[1] = 0;
+#endif
+
+  lockstep = true;
+  StartEepromThread(NULL);
+  return StartMainLockstep(false);
+}
+
+bool OpenTxSimulator::step()
+{
+  return StepMainLockstep();
+}
+
 void OpenTxSimulator::stop()
 {
+  if (lockstep) {
+    StopMainLockstep();
+    StopEepromThread();
+    lockstep = false;
+    return;
+  }
+
   StopMainThread();
 #if defined(CPUARM)  
   StopAudioThread();
@@ -83,6 +83,7 @@ class DLLEXPORT OpenTxSimulator : public SimulatorInterface {
 
   private:
     int volumeGain;
+    bool lockstep;
 
   public:
 
@@ -98,11 +99,15 @@ class DLLEXPORT OpenTxSimulator : public SimulatorInterface {
 
     virtual void stop();
 
+    virtual bool startLockstep(QByteArray & eeprom);
+
+    virtual bool step();
+
     virtual bool timer10ms();
 
     virtual uint8_t * getLcd();
 
-    virtual bool lcdChanged(bool & lightEnable);
+    virtual bool lcdChanged(bool & lightEnable, int & firstRow, int & lastRow);
 
     virtual void setValues(TxInputs &inputs);
 
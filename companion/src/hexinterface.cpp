@@ -14,6 +14,7 @@
  *
  */
 
+#include <string.h>
 #include "hexinterface.h"
 
 HexInterface::HexInterface(QTextStream &stream):
@@ -21,111 +22,163 @@ HexInterface::HexInterface(QTextStream &stream):
 {
 }
 
-int HexInterface::getValueFromLine(const QString &line, int pos, int len)
+static inline int hexNibble(char c)
 {
-    bool ok;
-    int hex = line.mid(pos,len).toInt(&ok, 16);
-    return ok ? hex : -1;
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  else if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  else if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  else
+    return -1;
+}
+
+int HexInterface::getValueFromLine(const char * line, int len)
+{
+  int hex = 0;
+  for (int i=0; i<len; i++) {
+    int nibble = hexNibble(line[i]);
+    if (nibble < 0)
+      return -1;
+    hex = (hex << 4) + nibble;
+  }
+  return hex;
 }
 
 int HexInterface::load(uint8_t *data, int maxsize)
 {
+  // the whole text is converted once, the records are then decoded in place
+  QByteArray text = stream.readAll().toLatin1();
+  const char * ptr = text.constData();
+  const char * end = ptr + text.size();
+
   int result = 0;
   int offset = 0;
-  while (!stream.atEnd()) {
-    QString line = stream.readLine();
-
-    if(line.left(1)!=":") continue;
-    
-    int byteCount = getValueFromLine(line,1);
-    int address = getValueFromLine(line,3,4);
-    int recType = getValueFromLine(line,7);
+  while (ptr < end) {
+    const char * line = ptr;
+    const char * eol = (const char *)memchr(ptr, '\n', end - ptr);
+    if (!eol)
+      eol = end;
+    ptr = eol + 1;
+
+    if (*line != ':') continue;
+
+    int lineLen = eol - line;
+    if (lineLen < 11)
+      return 0;
+
+    int byteCount = getValueFromLine(line+1);
+    int address = getValueFromLine(line+3, 4);
+    int recType = getValueFromLine(line+7);
     if (recType==0x02) {
         offset+=0x010000;
     }
-    if(byteCount<0 || address<0 || recType<0)
+    if(byteCount<0 || address<0 || recType<0 || lineLen < byteCount*2+11)
       return 0;
 
-    QByteArray ba;
-    ba.clear();
-
     quint8 chkSum = 0;
     chkSum -= byteCount;
     chkSum -= recType;
     chkSum -= address & 0xFF;
     chkSum -= address >> 8;
-    for(int i=0; i<byteCount; i++)
-    {
-        quint8 v = getValueFromLine(line,(i*2)+9) & 0xFF;
-        chkSum -= v;
-        ba.append(v);
-    }
 
-    quint8 retV = getValueFromLine(line,(byteCount*2)+9) & 0xFF;
-    if(chkSum!=retV)
+    if (address+offset + byteCount > maxsize)
       return 0;
 
-    if (address+offset + byteCount <= maxsize) {
-      if (recType == 0x00) { //data record - ba holds record
-        memcpy(&data[address+offset],ba.data(),byteCount);
-        result = std::max(result, address+offset+byteCount);
-      }
+    // the record is only written once its checksum is verified
+    uint8_t record[255];
+    for (int i=0; i<byteCount; i++) {
+      int v = getValueFromLine(line+(i*2)+9);
+      if (v < 0)
+        return 0;
+      chkSum -= v;
+      record[i] = v;
     }
-    else {
+
+    int retV = getValueFromLine(line+(byteCount*2)+9);
+    if (chkSum!=retV)
       return 0;
+
+    if (recType == 0x00) { //data record
+      memcpy(&data[address+offset], record, byteCount);
+      result = std::max(result, address+offset+byteCount);
     }
   }
-  
+
   return result;
 }
 
+static const char hexDigits[] = "0123456789ABCDEF";
+
+static inline char * appendHexByte(char * str, quint8 value)
+{
+  *str++ = hexDigits[value >> 4];
+  *str++ = hexDigits[value & 0x0F];
+  return str;
+}
 
 bool HexInterface::save(uint8_t *data, const int size)
 {
+  // 32 bytes per record => 77 chars per line, the extended records are shorter
+  QByteArray text;
+  text.reserve((size/32 + size/0x010000 + 2) * 80);
+
   int addr = 0;
   int nextbank = 1;
   while (addr < size) {
     if (addr>(nextbank*0x010000)-1) {
-      stream << iHEXExtRec(nextbank) << "\n";
+      iHEXExtRec(text, nextbank);
       nextbank++;
     }
     int llen = 32;
     if ((size - addr) < llen)
       llen = size - addr;
-    stream << iHEXLine(data, addr, llen) << "\n";
+    iHEXLine(text, data, addr, llen);
     addr += llen;
   }
-  stream << ":00000001FF\n"; // write EOF
+  text.append(":00000001FF\n"); // write EOF
+  stream << text.constData();
   return true;
 }
 
-QString HexInterface::iHEXLine(quint8 * data, quint32 addr, quint8 len)
+void HexInterface::iHEXLine(QByteArray & text, quint8 * data, quint32 addr, quint8 len)
 {
+  char line[2*255+12];
+  char * str = line;
   unsigned int bankaddr;
   bankaddr=addr&0xffff;
-  QString str = QString(":%1%2000").arg(len, 2, 16, QChar('0')).arg(bankaddr, 4, 16, QChar('0')); //write start, bytecount (32), address and record type
+  *str++ = ':'; //write start, bytecount (32), address and record type
+  str = appendHexByte(str, len);
+  str = appendHexByte(str, bankaddr >> 8);
+  str = appendHexByte(str, bankaddr & 0xFF);
+  str = appendHexByte(str, 0x00);
   quint8 chkSum = 0;
   chkSum = -len; //-bytecount; recordtype is zero
   chkSum -= bankaddr & 0xFF;
   chkSum -= bankaddr >> 8;
   for (int j = 0; j < len; j++) {
-    str += QString("%1").arg(data[addr + j], 2, 16, QChar('0'));
+    str = appendHexByte(str, data[addr + j]);
     chkSum -= data[addr + j];
   }
-
-  str += QString("%1").arg(chkSum, 2, 16, QChar('0'));
-  return str.toUpper(); // output to file and lf;
+  str = appendHexByte(str, chkSum);
+  *str++ = '\n';
+  text.append(line, str - line);
 }
 
-QString HexInterface::iHEXExtRec(quint8 bank)
+void HexInterface::iHEXExtRec(QByteArray & text, quint8 bank)
 {
-  QString str = QString(":02000002"); //write record type 2 record
+  char line[16];
+  char * str = line;
   quint8 chkSum = 0;
   chkSum = -2; //-bytecount; recordtype is zero
   chkSum -= 2; // type 2 record type
-  str += QString("%1000").arg((bank&0x0f)<<4,1,16,QChar('0'));
-  chkSum -= ((bank&0x0f)<<4); // type 2 record type
-  str += QString("%1").arg(chkSum, 2, 16, QChar('0'));
-  return str.toUpper(); // output to file and lf;
+  chkSum -= ((bank&0x0f)<<4);
+  memcpy(str, ":02000002", 9); //write record type 2 record
+  str += 9;
+  str = appendHexByte(str, (bank&0x0f)<<4);
+  str = appendHexByte(str, 0x00);
+  str = appendHexByte(str, chkSum);
+  *str++ = '\n';
+  text.append(line, str - line);
 }
-
@@ -28,9 +28,9 @@ class HexInterface {
 
   protected:
 
-    int getValueFromLine(const QString &line, int pos, int len=2);
-    QString iHEXLine(quint8 * data, quint32 addr, quint8 len);
-    QString iHEXExtRec(quint8 bank);
+    int getValueFromLine(const char * line, int len=2);
+    void iHEXLine(QByteArray & text, quint8 * data, quint32 addr, quint8 len);
+    void iHEXExtRec(QByteArray & text, quint8 bank);
 
     QTextStream & stream;
 };
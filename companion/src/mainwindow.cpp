@@ -663,6 +663,16 @@ void MainWindow::contributors()
 }
 
 void MainWindow::sdsync()
+{
+  sdsync(false);
+}
+
+void MainWindow::sdsyncPreview()
+{
+  sdsync(true);
+}
+
+void MainWindow::sdsync(bool dryRun)
 {
   QString sdPath = g.profile[g.id()].sdPath();
   if (sdPath.isEmpty()) {
@@ -675,8 +685,8 @@ void MainWindow::sdsync()
     return;
   }
   massstoragePath = massstoragePath.left(massstoragePath.length() - 7);
-  ProgressDialog progressDialog(this, tr("Synchronize SD"), CompanionIcon("sdsync.png"));
-  SyncProcess syncProcess(massstoragePath, g.profile[g.id()].sdPath(), progressDialog.progress());
+  ProgressDialog progressDialog(this, dryRun ? tr("Preview SD Synchronization") : tr("Synchronize SD"), CompanionIcon("sdsync.png"));
+  SyncProcess syncProcess(massstoragePath, g.profile[g.id()].sdPath(), progressDialog.progress(), dryRun);
   if (!syncProcess.run()) {
     progressDialog.exec();
   }
@@ -1069,6 +1079,7 @@ void MainWindow::createActions()
     readBackupToFileAct = addAct("read_eeprom_file.png", tr("Backup Radio to File"), tr("Save a complete backup file of all settings and model data in the Radio"), SLOT(readBackup()));
     contributorsAct =    addAct("contributors.png",  tr("Contributors..."), tr("A tribute to those who have contributed to OpenTX and Companion"), SLOT(contributors()));
     sdsyncAct =          addAct("sdsync.png",        tr("Synchronize SD"),          tr("SD card synchronization"),            SLOT(sdsync()));
+    sdsyncPreviewAct =   addAct("sdsync.png",        tr("Preview SD Synchronization"), tr("List the changes an SD card synchronization would make"), SLOT(sdsyncPreview()));
 
     compareAct->setEnabled(false);
     simulateAct->setEnabled(false);
@@ -1099,6 +1110,7 @@ void MainWindow::createMenus()
     fileMenu->addAction(printAct);
     fileMenu->addAction(compareAct);
     fileMenu->addAction(sdsyncAct);
+    fileMenu->addAction(sdsyncPreviewAct);
     fileMenu->addSeparator();
     fileMenu->addAction(exitAct);
 
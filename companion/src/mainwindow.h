@@ -148,6 +148,7 @@ class MainWindow : public QMainWindow
     void simulate();
     void contributors();
     void sdsync();
+    void sdsyncPreview();
     void changelog();
     void fwchangelog();
     void customizeSplash();
@@ -168,6 +169,7 @@ class MainWindow : public QMainWindow
   private:
     void closeUpdatesWaitDialog();
     void onUpdatesError();
+    void sdsync(bool dryRun);
 
     void createActions();
     QAction * addAct(const QString &, const QString &, const QString &, enum QKeySequence::StandardKey, const char *, QObject *slotObj=NULL);
@@ -228,6 +230,7 @@ class MainWindow : public QMainWindow
     QAction *checkForUpdatesAct;
     QAction *contributorsAct;
     QAction *sdsyncAct;
+    QAction *sdsyncPreviewAct;
     QAction *changelogAct;
     QAction *fwchangelogAct;
     QAction *compareAct;
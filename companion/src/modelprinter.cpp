@@ -1,6 +1,14 @@
 #include "helpers.h"
 #include "modelprinter.h"
 #include <QPainter>
+#include <QCache>
+#include <QMutex>
+#include <QDataStream>
+#include <QCryptographicHash>
+
+// Rendered curves, shared by all printers and keyed by the curve contents, the cost is in KB
+static QCache<QString, QImage> curveImages(16*1024);
+static QMutex curveImagesMutex;
 
 QString changeColor(const QString & input, const QString & to, const QString & from)
 {
@@ -614,8 +622,8 @@ QString ModelPrinter::printCurve(int idx)
 }
 
 CurveImage::CurveImage():
-  size(200),
-  image(size+1, size+1, QImage::Format_RGB32),
+  size(CURVE_IMAGE_SIZE-1),
+  image(CURVE_IMAGE_SIZE, CURVE_IMAGE_SIZE, QImage::Format_RGB32),
   painter(&image)
 {
   painter.setBrush(QBrush("#FFFFFF"));
@@ -642,12 +650,44 @@ void CurveImage::drawCurve(const CurveData & curve, QColor color)
   }
 }
 
-QString ModelPrinter::createCurveImage(int idx, QTextDocument * document)
+QString CurveImage::name(const CurveData & curve, QColor color)
+{
+  QByteArray key;
+  QDataStream stream(&key, QIODevice::WriteOnly);
+  stream << (int)curve.type << curve.smooth << curve.count << color.rgb();
+  for (int i=0; i<curve.count; i++) {
+    stream << curve.points[i].x << curve.points[i].y;
+  }
+  return QString("curve-%1.png").arg(QString(QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex()));
+}
+
+// May be called from any thread
+QImage CurveImage::render(const CurveData & curve, QColor color)
+{
+  QString filename = name(curve, color);
+  QImage result;
+  if (!cached(filename, result)) {
+    CurveImage image;
+    image.drawCurve(curve, color);
+    result = image.get();
+    QMutexLocker locker(&curveImagesMutex);
+    curveImages.insert(filename, new QImage(result), result.byteCount() / 1024);
+  }
+  return result;
+}
+
+bool CurveImage::cached(const QString & name, QImage & image)
+{
+  QMutexLocker locker(&curveImagesMutex);
+  QImage * result = curveImages.object(name);
+  if (result) {
+    image = *result;
+    return true;
+  }
+  return false;
+}
+
+QString ModelPrinter::curveImageName(int idx)
 {
-  CurveImage image;
-  image.drawCurve(model.curves[idx], colors[idx]);
-  QString filename = QString("curve-%1-%2.png").arg((uint64_t)this).arg(idx);
-  if (document) document->addResource(QTextDocument::ImageResource, QUrl(filename), image.get());
-  // qDebug() << "ModelPrinter::createCurveImage()" << idx << filename;
-  return ":" + filename;
+  return CurveImage::name(model.curves[idx], colors[idx]);
 }
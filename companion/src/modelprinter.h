@@ -13,6 +13,8 @@ QString addFont(const QString & input, const QString & color = "", const QString
 
 void debugHtml(const QString & html);
 
+#define CURVE_IMAGE_SIZE  201 // pixels, the grid goes from 0 to 200
+
 class CurveImage
 {
   public:
@@ -20,6 +22,10 @@ class CurveImage
     void drawCurve(const CurveData & curve, QColor color);
     const QImage & get() const { return image; };
 
+    static QString name(const CurveData & curve, QColor color);
+    static QImage render(const CurveData & curve, QColor color);
+    static bool cached(const QString & name, QImage & image);
+
   protected:
     int size;
     QImage image;
@@ -61,7 +67,7 @@ class ModelPrinter: public QObject
     static QString printChannelName(int idx);
     QString printOutputName(int idx);
     QString printCurve(int idx);
-    QString createCurveImage(int idx, QTextDocument * document);
+    QString curveImageName(int idx);
 
   private:
     Firmware * firmware;
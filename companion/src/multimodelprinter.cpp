@@ -2,6 +2,8 @@
 #include "helpers_html.h"
 #include "multimodelprinter.h"
 #include <algorithm>
+#include <QtConcurrentMap>
+#include <QTextBlock>
 
 MultiModelPrinter::MultiColumns::MultiColumns(int count):
   count(count),
@@ -94,13 +96,21 @@ QString MultiModelPrinter::printTitle(const QString & label)
   return QString("<tr><td colspan='%1'><h2>").arg(modelPrinters.count()) + label + "</h2></td></tr>";
 }
 
+QImage MultiModelPrinter::renderCurveJob(const CurveJob & job)
+{
+  return CurveImage::render(job.curve, job.color);
+}
+
 MultiModelPrinter::MultiModelPrinter(Firmware * firmware):
-  firmware(firmware)
+  firmware(firmware),
+  curvesDocument(NULL)
 {
+  connect(&curvesWatcher, SIGNAL(resultReadyAt(int)), this, SLOT(onCurveImageReady(int)));
 }
 
 MultiModelPrinter::~MultiModelPrinter()
 {
+  cancelCurves();
   for(int i=0; i<modelPrinters.size(); i++) {
     delete modelPrinters[i];
   }
@@ -122,8 +132,71 @@ void MultiModelPrinter::setModel(int idx, const ModelData & model)
   modelPrinters[idx] = new ModelPrinter(firmware, defaultSettings, model);
 }
 
+void MultiModelPrinter::cancelCurves()
+{
+  curvesWatcher.cancel();
+  curvesWatcher.waitForFinished();
+  curvesWatcher.setFuture(QFuture<QImage>());
+  curveJobs.clear();
+  curvePositions.clear();
+  curvesDocument = NULL;
+}
+
+void MultiModelPrinter::addCurveImage(int idx, int curve, QTextDocument * document)
+{
+  const CurveData & data = models[idx]->curves[curve];
+  QString name = modelPrinters[idx]->curveImageName(curve);
+  QImage image;
+  if (CurveImage::cached(name, image)) {
+    document->addResource(QTextDocument::ImageResource, QUrl(name), image);
+  }
+  else {
+    foreach (const CurveJob & job, curveJobs) {
+      if (job.name == name)
+        return;
+    }
+    CurveJob job = { name, data, colors[curve] };
+    curveJobs << job;
+  }
+}
+
+// Only the image characters are laid out again, their positions are looked up once
+void MultiModelPrinter::onCurveImageReady(int index)
+{
+  if (curvesDocument && index < curveJobs.size() && curvesWatcher.future().isResultReadyAt(index)) {
+    if (curvePositions.isEmpty()) {
+      for (QTextBlock block = curvesDocument->begin(); block != curvesDocument->end(); block = block.next()) {
+        for (QTextBlock::iterator it = block.begin(); !it.atEnd(); ++it) {
+          QTextFragment fragment = it.fragment();
+          QTextImageFormat format = fragment.charFormat().toImageFormat();
+          if (format.isValid()) {
+            curvePositions.insert(format.name(), fragment.position());
+          }
+        }
+      }
+    }
+    const QString & name = curveJobs[index].name;
+    curvesDocument->addResource(QTextDocument::ImageResource, QUrl(name), curvesWatcher.resultAt(index));
+    foreach (int position, curvePositions.values(":" + name)) {
+      curvesDocument->markContentsDirty(position, 1);
+    }
+  }
+}
+
+// To be called before the document is printed or saved, the curves are displayed progressively otherwise
+void MultiModelPrinter::waitForCurves()
+{
+  if (curvesDocument) {
+    curvesWatcher.waitForFinished();
+    for (int i=0; i<curveJobs.size(); i++) {
+      onCurveImageReady(i);
+    }
+  }
+}
+
 QString MultiModelPrinter::print(QTextDocument * document)
 {
+  cancelCurves();
   if (document) document->clear();
 
   QString str = "<table border='1' cellspacing='0' cellpadding='3' width='100%' style='font-family: monospace;'>";
@@ -142,6 +215,12 @@ QString MultiModelPrinter::print(QTextDocument * document)
   str += printCustomFunctions();
   str += printTelemetry();
   str += "</table>";
+
+  if (document && !curveJobs.isEmpty()) {
+    curvesDocument = document;
+    curvesWatcher.setFuture(QtConcurrent::mapped(curveJobs, renderCurveJob));
+  }
+
   return str;
 }
 
@@ -439,8 +518,10 @@ QString MultiModelPrinter::printCurves(QTextDocument * document)
       count++;
       columns.append("<tr><td width='20%'><b>" + tr("CV%1").arg(i+1) + "</b></td><td>");
       COMPARE(modelPrinter->printCurve(i));
-      for (int k=0; k<models.size(); k++)
-        columns.append(k, QString("<br/><img src='%1' border='0' />").arg(modelPrinters[k]->createCurveImage(i, document)));
+      for (int k=0; k<models.size(); k++) {
+        if (document) addCurveImage(k, i, document);
+        columns.append(k, QString("<br/><img src='%1' width='%2' height='%2' border='0' />").arg(":" + modelPrinters[k]->curveImageName(i)).arg(CURVE_IMAGE_SIZE));
+      }
       columns.append("</td></tr>");
     }
   }
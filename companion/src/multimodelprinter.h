@@ -3,6 +3,9 @@
 
 #include <QObject>
 #include <QTextDocument>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QHash>
 #include "eeprominterface.h"
 #include "modelprinter.h"
 
@@ -16,6 +19,10 @@ class MultiModelPrinter: public QObject
     
     void setModel(int idx, const ModelData & model);
     QString print(QTextDocument * document);
+    void waitForCurves();
+
+  protected slots:
+    void onCurveImageReady(int index);
 
   protected:
     class MultiColumns {
@@ -41,6 +48,21 @@ class MultiModelPrinter: public QObject
     QVector<ModelData *> models; // TODO const
     QVector<ModelPrinter *> modelPrinters;
 
+    // Curve images which were not in the cache, rendered on the thread pool
+    // and added to the document as soon as they are ready
+    struct CurveJob {
+      QString name;
+      CurveData curve;
+      QColor color;
+    };
+    QList<CurveJob> curveJobs;
+    QFutureWatcher<QImage> curvesWatcher;
+    QTextDocument * curvesDocument;
+    QMultiHash<QString, int> curvePositions;
+    static QImage renderCurveJob(const CurveJob & job);
+    void addCurveImage(int idx, int curve, QTextDocument * document);
+    void cancelCurves();
+
     QString printTitle(const QString & label);
     QString printSetup();
     QString printHeliSetup();
@@ -45,6 +45,7 @@ void PrintDialog::on_printButton_clicked()
   dialog->setWindowTitle(tr("Print Document"));
   if (dialog->exec() != QDialog::Accepted)
     return;
+  multimodelprinter.waitForCurves();
   ui->textEdit->print(&printer);
 }
 
@@ -55,6 +56,7 @@ void PrintDialog::on_printFileButton_clicked()
     return;
   if (! (fn.endsWith(".odt", Qt::CaseInsensitive) || fn.endsWith(".pdf", Qt::CaseInsensitive) || fn.endsWith(".htm", Qt::CaseInsensitive) || fn.endsWith(".html", Qt::CaseInsensitive)) )
     fn += ".pdf"; // default
+  multimodelprinter.waitForCurves();
   if (fn.endsWith(".pdf", Qt::CaseInsensitive)) {
     QPrinter printer;
     printer.setPageMargins(10.0,10.0,10.0,10.0,printer.Millimeter);
@@ -75,6 +77,7 @@ void PrintDialog::printToFile()
     return;
   if (! (printfilename.endsWith(".odt", Qt::CaseInsensitive) || printfilename.endsWith(".pdf", Qt::CaseInsensitive) || printfilename.endsWith(".htm", Qt::CaseInsensitive) || printfilename.endsWith(".html", Qt::CaseInsensitive)) )
     printfilename += ".pdf"; // default
+  multimodelprinter.waitForCurves();
   if (printfilename.endsWith(".pdf", Qt::CaseInsensitive)) {
     QPrinter printer;
     printer.setPageMargins(10.0,10.0,10.0,10.0,printer.Millimeter);
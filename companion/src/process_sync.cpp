@@ -6,22 +6,61 @@
 #include <QTextStream>
 #include <QDebug>
 #include <QEventLoop>
-#include <QTimer>
+#include <QCryptographicHash>
+#include <QDesktopServices>
+#include <QDataStream>
+#include <QtConcurrentMap>
+#include <QCoreApplication>
 
-SyncProcess::SyncProcess(const QString & folder1, const QString & folder2, ProgressWidget * progress):
+#define SYNC_CHUNK_SIZE        (64*1024)
+#define SYNC_MANIFEST_VERSION  3
+#define SYNC_MTIME_MARGIN      2   // seconds, the FAT modification times have a 2s resolution
+
+struct SyncWorker
+{
+  typedef void result_type;
+
+  SyncWorker(SyncProcess * process):
+    process(process)
+  {
+  }
+
+  void operator()(const SyncProcess::SyncTask & task)
+  {
+    process->processTask(task);
+  }
+
+  SyncProcess * process;
+};
+
+SyncProcess::SyncProcess(const QString & folder1, const QString & folder2, ProgressWidget * progress, bool dryRun):
   folder1(folder1),
   folder2(folder2),
   progress(progress),
-  index(0),
+  dryRun(dryRun),
   count(0),
   closed(false)
 {
   connect(progress, SIGNAL(stopped()),this, SLOT(onClosed()));
+  connect(this, SIGNAL(message(const QString &)), this, SLOT(onMessage(const QString &)), Qt::QueuedConnection);
+  connect(&watcher, SIGNAL(progressValueChanged(int)), this, SLOT(onProgress(int)));
 }
 
 void SyncProcess::onClosed()
 {
   closed = true;
+  watcher.cancel();
+}
+
+void SyncProcess::onMessage(const QString & text)
+{
+  progress->addText(text + "\n");
+}
+
+void SyncProcess::onProgress(int value)
+{
+  progress->setInfo(tr("%1/%2 files").arg(value).arg(count));
+  progress->setValue(value);
 }
 
 bool SyncProcess::run()
@@ -36,10 +75,38 @@ bool SyncProcess::run()
     return true;
   }
 
-  count = getFilesCount(folder1) + getFilesCount(folder2);
-  progress->setMaximum(count);
+  if (dryRun) {
+    progress->addText(tr("Dry run, nothing will be written") + "\n");
+  }
+
+  loadManifest();
+
+  // the directories are created while scanning, files are compared and copied in parallel afterwards
+  scanDir(folder1, folder2);
+  scanDir(folder2, folder1);
+
+  count = tasks.count();
+  progress->setMaximum(qMax(count, 1));
+  onProgress(0);
+
+  if (!closed && count > 0) {
+    QEventLoop loop;
+    connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(QtConcurrent::map(tasks, SyncWorker(this)));
+    loop.exec();
+    watcher.waitForFinished();
+  }
+
+  if (!closed) {
+    onProgress(count);
+    progress->setValue(progress->maximum());
+    saveManifest();
+  }
+
+  if (dryRun && !closed) {
+    progress->addText(tr("Dry run finished") + "\n");
+  }
 
-  QStringList errors = updateDir(folder1, folder2) + updateDir(folder2, folder1);
   if (errors.count() > 0) {
     QMessageBox::warning(NULL, QObject::tr("Synchronization error"), errors.join("\n"));
   }
@@ -48,95 +115,231 @@ bool SyncProcess::run()
   return closed;
 }
 
-int SyncProcess::getFilesCount(const QString & directory)
+// The files and directories the operating systems add on the SD card are not synchronized
+static bool isSystemEntry(const QString & relativePath)
 {
-  int result = 0;
-  QDirIterator it(directory, QDirIterator::Subdirectories);
-  while (it.hasNext()) {
-    it.next();
-    result++;
+  static const QStringList names = QStringList() << "System Volume Information" << "$RECYCLE.BIN" << ".Trashes"
+                                                 << ".Spotlight-V100" << ".fseventsd" << ".DS_Store" << "Thumbs.db";
+  foreach (const QString & name, relativePath.split('/')) {
+    if (names.contains(name, Qt::CaseInsensitive) || name.startsWith("._")) {
+      return true;
+    }
   }
-  return result;
+  return false;
 }
 
-QStringList SyncProcess::updateDir(const QString & source, const QString & destination)
+void SyncProcess::scanDir(const QString & source, const QString & destination)
 {
-  QDirIterator it(source, QDirIterator::Subdirectories);
+  QDir sourceDir(source);
+  QDir destinationDir(destination);
+  QDirIterator it(source, QDir::AllEntries | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
   while (!closed && it.hasNext()) {
-    QEventLoop loop;
-    QTimer::singleShot(10, &loop, SLOT(quit()));
-    loop.exec();
-    index++;
-    progress->setInfo(tr("%1/%2 files").arg(index).arg(count));
-    progress->setValue(index);
-    QString result = updateEntry(it.next(), source, destination);
-    if (!result.isEmpty()) {
-      errors << result;
+    // keep the Stop button working on a large card
+    QCoreApplication::processEvents();
+    QString path = it.next();
+    QFileInfo sourceInfo = it.fileInfo();
+    QString relativePath = sourceDir.relativeFilePath(path);
+    if (isSystemEntry(relativePath)) {
+      continue;
+    }
+    QString destinationPath = destinationDir.absoluteFilePath(relativePath);
+    QFileInfo destinationInfo(destinationPath);
+    scanned.insert(sourceInfo.absoluteFilePath());
+    if (sourceInfo.isDir()) {
+      if (!destinationInfo.exists()) {
+        progress->addText(tr("Create directory %1\n").arg(destinationPath));
+        if (!dryRun && !destinationDir.mkdir(relativePath)) {
+          addError(QObject::tr("Create '%1' failed").arg(destinationPath));
+        }
+      }
+    }
+    else if (!destinationInfo.exists()) {
+      SyncTask task = { SYNC_COPY, path, destinationPath };
+      tasks << task;
+    }
+    else if (sourceInfo.lastModified() > destinationInfo.lastModified()) {
+      SyncTask task = { SYNC_UPDATE, path, destinationPath };
+      tasks << task;
     }
   }
-  return errors;
 }
 
-QString SyncProcess::updateEntry(const QString & path, const QDir & source, const QDir & destination)
+// Called from the worker threads, the progress widget is only reached through the message() signal
+void SyncProcess::processTask(const SyncTask & task)
 {
-  QFileInfo sourceInfo(path);
-  QString relativePath = source.relativeFilePath(path);
-  QString destinationPath = destination.absoluteFilePath(relativePath);
-  QFileInfo destinationInfo(destinationPath);
-  if (sourceInfo.isDir()) {
-    if (!destinationInfo.exists()) {
-      progress->addText(tr("Create directory %1\n").arg(destinationPath));
-      if (!destination.mkdir(relativePath)) {
-        return QObject::tr("Create '%1' failed").arg(destinationPath);
-      }
-    }
+  if (closed) {
+    return;
+  }
+
+  if (task.action == SYNC_COPY) {
+    emit message(tr("Copy %1 to %2").arg(task.source).arg(task.destination));
   }
   else {
-    if (!destinationInfo.exists()) {
-      // qDebug() << "Copy" << path << "to" << destinationPath;
-      progress->addText(tr("Copy %1 to %2").arg(path).arg(destinationPath) + "\n");
-      if (!QFile::copy(path, destinationPath)) {
-        return QObject::tr("Copy '%1' to '%2' failed").arg(path).arg(destinationPath);
+    QFileInfo sourceInfo(task.source);
+    QFileInfo destinationInfo(task.destination);
+    if (sourceInfo.size() == destinationInfo.size()) {
+      QByteArray sourceHash = fileHash(task.source, sourceInfo);
+      QByteArray destinationHash = fileHash(task.destination, destinationInfo);
+      if (sourceHash.isEmpty()) {
+        addError(QObject::tr("Open '%1' failed").arg(task.source));
+        return;
       }
-    }
-    else if (sourceInfo.lastModified() > destinationInfo.lastModified()) {
-      // retrieve source contents
-      QFile sourceFile(path);
-      if (!sourceFile.open(QFile::ReadOnly)) {
-        return QObject::tr("Open '%1' failed").arg(path);
+      if (destinationHash.isEmpty()) {
+        addError(QObject::tr("Open '%1' failed").arg(task.destination));
+        return;
       }
-      QByteArray sourceContents = sourceFile.readAll();
-      sourceFile.close();
-
-      // retrieve destination contents
-      QFile destinationFile(destinationPath);
-      if (!destinationFile.open(QFile::ReadOnly)) {
-        return QObject::tr("Open '%1' failed").arg(destinationPath);
+      if (sourceHash == destinationHash) {
+        return;
       }
-      QByteArray destinationContents = destinationFile.readAll();
-      destinationFile.close();
+    }
+    emit message(tr("Write %1").arg(task.destination));
+  }
 
-      if (contentsDifferent(sourceContents, destinationContents)) {
-        // copy contents
-        if (!destinationFile.open(QFile::WriteOnly | QIODevice::Truncate)) {
-          return QObject::tr("Write '%1' failed").arg(destinationPath);
-        }
-        progress->addText(tr("Write %1").arg(destinationPath) + "\n");
-        // qDebug() << "Write" << destinationPath;
-        destinationFile.write(sourceContents);
-        destinationFile.close();
-      }
+  if (!dryRun) {
+    QString error = copyFile(task.source, task.destination);
+    if (!error.isEmpty()) {
+      addError(error);
+    }
+  }
+}
+
+QString SyncProcess::copyFile(const QString & source, const QString & destination)
+{
+  QFile sourceFile(source);
+  if (!sourceFile.open(QFile::ReadOnly)) {
+    return QObject::tr("Open '%1' failed").arg(source);
+  }
+
+  QFile destinationFile(destination);
+  if (!destinationFile.open(QFile::WriteOnly | QIODevice::Truncate)) {
+    return QObject::tr("Write '%1' failed").arg(destination);
+  }
+
+  uint hashed = QDateTime::currentDateTime().toTime_t();
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  while (!sourceFile.atEnd()) {
+    QByteArray chunk = sourceFile.read(SYNC_CHUNK_SIZE);
+    if (chunk.isEmpty() || destinationFile.write(chunk) != chunk.size()) {
+      return QObject::tr("Copy '%1' to '%2' failed").arg(source).arg(destination);
     }
+    hash.addData(chunk);
   }
+  destinationFile.close();
+
+  // both files now have the same contents, remember it for the next synchronization. The
+  // destination was just written, its modification time is too recent to trust its hash the
+  // usual way, but its hash is the one of the data written
+  QFileInfo sourceInfo(source);
+  QFileInfo destinationInfo(destination);
+  QMutexLocker locker(&mutex);
+  ManifestEntry entry = { sourceInfo.size(), sourceInfo.lastModified().toTime_t(), hashed, false, hash.result() };
+  manifest.insert(sourceInfo.absoluteFilePath(), entry);
+  entry.lastModified = destinationInfo.lastModified().toTime_t();
+  entry.written = true;
+  manifest.insert(destinationInfo.absoluteFilePath(), entry);
+  scanned.insert(destinationInfo.absoluteFilePath());
   return QString();
 }
 
-bool SyncProcess::contentsDifferent(const QByteArray & source, const QByteArray & dest) {
-  if (source.size() != dest.size()) return true;
-  for(int n=0; n<source.size(); ++n) {
-    if (source[n] != dest[n]) {
-      return true;
+// Returns the MD5 of a file, from the manifest when its size and date didn't change.
+// The modification time has a resolution of 1s (2s on FAT), a hash computed soon after the
+// last modification could miss a later one which kept the same time and size, it isn't trusted
+// unless the synchronization wrote the file itself
+QByteArray SyncProcess::fileHash(const QString & path, const QFileInfo & info)
+{
+  QString key = info.absoluteFilePath();
+  uint lastModified = info.lastModified().toTime_t();
+  uint hashed = QDateTime::currentDateTime().toTime_t();
+
+  {
+    QMutexLocker locker(&mutex);
+    QHash<QString, ManifestEntry>::const_iterator it = manifest.constFind(key);
+    if (it != manifest.constEnd() && it->size == info.size() && it->lastModified == lastModified && (it->written || it->hashed > lastModified + SYNC_MTIME_MARGIN)) {
+      return it->hash;
     }
   }
-  return false;
-}
\ No newline at end of file
+
+  QFile file(path);
+  if (!file.open(QFile::ReadOnly)) {
+    return QByteArray();
+  }
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  while (!file.atEnd()) {
+    QByteArray chunk = file.read(SYNC_CHUNK_SIZE);
+    if (chunk.isEmpty()) {
+      return QByteArray();
+    }
+    hash.addData(chunk);
+  }
+
+  QMutexLocker locker(&mutex);
+  ManifestEntry entry = { info.size(), lastModified, hashed, false, hash.result() };
+  manifest.insert(key, entry);
+  return entry.hash;
+}
+
+void SyncProcess::addError(const QString & error)
+{
+  QMutexLocker locker(&mutex);
+  errors << error;
+}
+
+QString SyncProcess::manifestPath()
+{
+  QString folders = QDir(folder1).absolutePath() + "\n" + QDir(folder2).absolutePath();
+  QString name = QCryptographicHash::hash(folders.toUtf8(), QCryptographicHash::Md5).toHex();
+  return QDesktopServices::storageLocation(QDesktopServices::DataLocation) + "/sdsync-" + name + ".manifest";
+}
+
+void SyncProcess::loadManifest()
+{
+  QFile file(manifestPath());
+  if (!file.open(QFile::ReadOnly)) {
+    return;
+  }
+
+  QDataStream stream(&file);
+  quint32 version, entries;
+  stream >> version >> entries;
+  if (version != SYNC_MANIFEST_VERSION) {
+    return;
+  }
+
+  for (quint32 i=0; i<entries && stream.status() == QDataStream::Ok; i++) {
+    QString path;
+    ManifestEntry entry;
+    stream >> path >> entry.size >> entry.lastModified >> entry.hashed >> entry.written >> entry.hash;
+    manifest.insert(path, entry);
+  }
+
+  if (stream.status() != QDataStream::Ok) {
+    qDebug() << "SD sync manifest" << file.fileName() << "is corrupted";
+    manifest.clear();
+  }
+}
+
+void SyncProcess::saveManifest()
+{
+  // forget the files which were deleted since the last synchronization
+  QMutableHashIterator<QString, ManifestEntry> it(manifest);
+  while (it.hasNext()) {
+    it.next();
+    if (!scanned.contains(it.key())) {
+      it.remove();
+    }
+  }
+
+  QString path = manifestPath();
+  QDir().mkpath(QFileInfo(path).absolutePath());
+  QFile file(path);
+  if (!file.open(QFile::WriteOnly | QIODevice::Truncate)) {
+    qDebug() << "Unable to write SD sync manifest" << path;
+    return;
+  }
+
+  QDataStream stream(&file);
+  stream << (quint32)SYNC_MANIFEST_VERSION << (quint32)manifest.count();
+  for (QHash<QString, ManifestEntry>::const_iterator entry = manifest.constBegin(); entry != manifest.constEnd(); ++entry) {
+    stream << entry.key() << entry->size << entry->lastModified << entry->hashed << entry->written << entry->hash;
+  }
+}
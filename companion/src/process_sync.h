@@ -4,8 +4,13 @@
 #include <QString>
 #include <QStringList>
 #include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QFutureWatcher>
 
 class QDir;
+class QFileInfo;
 class ProgressWidget;
 
 class SyncProcess : public QObject
@@ -13,22 +18,56 @@ class SyncProcess : public QObject
     Q_OBJECT
 
   public:
-    SyncProcess(const QString & folder1, const QString & folder2, ProgressWidget * progress);
+    SyncProcess(const QString & folder1, const QString & folder2, ProgressWidget * progress, bool dryRun=false);
     bool run();
 
+    enum SyncAction {
+      SYNC_COPY,
+      SYNC_UPDATE
+    };
+
+    struct SyncTask {
+      SyncAction action;
+      QString source;
+      QString destination;
+    };
+
+    void processTask(const SyncTask & task);
+
+  signals:
+    void message(const QString & text);
+
   protected slots:
     void onClosed();
+    void onMessage(const QString & text);
+    void onProgress(int value);
 
   protected:
-    int getFilesCount(const QString & directory);
-    QStringList updateDir(const QString & source, const QString & destination);
-    QString updateEntry(const QString & path, const QDir & source, const QDir & destination);
-    bool contentsDifferent(const QByteArray & source, const QByteArray & dest);
+    struct ManifestEntry {
+      qint64 size;
+      uint lastModified;
+      uint hashed;        // time the hash was computed
+      bool written;       // the hash of the data the synchronization wrote itself
+      QByteArray hash;
+    };
+
+    void scanDir(const QString & source, const QString & destination);
+    QString copyFile(const QString & source, const QString & destination);
+    QByteArray fileHash(const QString & path, const QFileInfo & info);
+    void addError(const QString & error);
+    QString manifestPath();
+    void loadManifest();
+    void saveManifest();
     QString folder1;
     QString folder2;
     ProgressWidget * progress;
+    bool dryRun;
     QStringList errors;
-    int index;
+    QList<SyncTask> tasks;
+    QFutureWatcher<void> watcher;
+    QHash<QString, ManifestEntry> manifest;
+    QSet<QString> scanned;
+    QMutex mutex;
     int count;
     bool closed;
 };
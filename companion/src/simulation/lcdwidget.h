@@ -18,6 +18,7 @@
 #define lcd_widget_h
 
 #include <QWidget>
+#include <QPaintEvent>
 #include "appdata.h"
 
 class lcdWidget : public QWidget {
@@ -25,17 +26,10 @@ class lcdWidget : public QWidget {
     lcdWidget(QWidget * parent = 0):
       QWidget(parent),
       lcdBuf(NULL),
-      previousBuf(NULL),
       lightEnable(false)
     {
     }
 
-    ~lcdWidget()
-    {
-      if (previousBuf)
-        free(previousBuf);
-    }
-
     void setData(unsigned char *buf, int width, int height, int depth=1)
     {
       lcdBuf = buf;
@@ -46,8 +40,6 @@ class lcdWidget : public QWidget {
         lcdSize = (width * height) * (depth / 8);
       else
         lcdSize = (width * ((height+7)/8)) * depth;
-      previousBuf = (unsigned char *)malloc(lcdSize);
-      memset(previousBuf, 0, lcdSize);
     }
 
     void setBackgroundColor(int red, int green, int blue)
@@ -77,13 +69,16 @@ class lcdWidget : public QWidget {
       }
     }
 
-    void onLcdChanged(bool light)
+    void onLcdChanged(bool light, int firstRow, int lastRow)
     {
-      if (light != lightEnable || memcmp(previousBuf, lcdBuf, lcdSize)) {
+      if (light != lightEnable) {
         lightEnable = light;
-        memcpy(previousBuf, lcdBuf, lcdSize);
         update();
       }
+      else if (firstRow <= lastRow) {
+        int scale = pixelScale();
+        update(0, scale*firstRow, scale*lcdWidth, scale*(lastRow-firstRow+1));
+      }
     }
 
     virtual void mousePressEvent(QMouseEvent * event)
@@ -100,18 +95,25 @@ class lcdWidget : public QWidget {
     int lcdSize;
 
     unsigned char *lcdBuf;
-    unsigned char *previousBuf;
 
     bool lightEnable;
     int _r, _g, _b;
 
-    inline void doPaint(QPainter & p)
+    inline int pixelScale()
+    {
+      return lcdDepth >= 8 ? 1 : 2;
+    }
+
+    inline void doPaint(QPainter & p, int firstRow=0, int lastRow=-1)
     {
       QRgb rgb;
 
+      if (lastRow < 0 || lastRow >= lcdHeight)
+        lastRow = lcdHeight - 1;
+
       if (lcdDepth >= 8) {
         for (int x=0; x<lcdWidth; x++) {
-          for (int y=0; y<lcdHeight; y++) {
+          for (int y=firstRow; y<=lastRow; y++) {
             uint16_t z = ((uint16_t *)lcdBuf)[y * lcdWidth + x];
             rgb = qRgb(255*((z&0xF00)>>8)/0x0f, 255*((z&0x0F0)>>4)/0x0f, 255*(z&0x00F)/0x0f);
             p.setPen(rgb);
@@ -126,7 +128,7 @@ class lcdWidget : public QWidget {
           rgb = qRgb(161, 161, 161);
 
         p.setBackground(QBrush(rgb));
-        p.eraseRect(0, 0, 2*lcdWidth, 2*lcdHeight);
+        p.eraseRect(0, 2*firstRow, 2*lcdWidth, 2*(lastRow-firstRow+1));
 
         if (lcdBuf) {
           if (lcdDepth == 1) {
@@ -137,7 +139,7 @@ class lcdWidget : public QWidget {
 
           unsigned int previousDepth = 0xFF;
 
-          for (int y=0; y<lcdHeight; y++) {
+          for (int y=firstRow; y<=lastRow; y++) {
             unsigned int idx = (y*lcdDepth/8)*lcdWidth;
             unsigned int mask = (1 << (y%8));
             for (int x=0; x<lcdWidth; x++, idx++) {
@@ -167,10 +169,12 @@ class lcdWidget : public QWidget {
       }
     }
 
-    void paintEvent(QPaintEvent*)
+    void paintEvent(QPaintEvent * event)
     {
+      // only the rows which were damaged are painted again
       QPainter p(this);
-      doPaint(p);
+      int scale = pixelScale();
+      doPaint(p, event->rect().top() / scale, event->rect().bottom() / scale);
     }
 
 };
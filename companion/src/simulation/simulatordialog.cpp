@@ -55,6 +55,8 @@ SimulatorDialog::SimulatorDialog(QWidget * parent, SimulatorInterface *simulator
   simulator(simulator),
   lastPhase(-1),
   beepVal(0),
+  inputsSent(false),
+  outputsShown(false),
   TelemetrySimu(0),
   TrainerSimu(0),
   DebugOut(0),
@@ -653,8 +655,9 @@ void SimulatorDialog::onTimerEvent()
 
   if (tabWidget->currentIndex()==0) {
     bool lightEnable;
-    if (simulator->lcdChanged(lightEnable)) {
-      lcd->onLcdChanged(lightEnable);
+    int firstRow, lastRow;
+    if (simulator->lcdChanged(lightEnable, firstRow, lastRow)) {
+      lcd->onLcdChanged(lightEnable, firstRow, lastRow);
       if (lightOn != lightEnable) {
         setLightOn(lightEnable);
         lightOn = lightEnable;
@@ -708,6 +711,8 @@ void SimulatorDialog::start(QByteArray & eeprom)
   lastPhase = -1;
   numGvars = GetCurrentFirmware()->getCapability(Gvars);
   numFlightModes = GetCurrentFirmware()->getCapability(FlightModes);
+  inputsSent = false;
+  outputsShown = false;
   simulator->start(eeprom, (flags & SIMULATOR_FLAGS_NOTX) ? false : true);
   getValues();
   setupTimer();
@@ -718,6 +723,8 @@ void SimulatorDialog::start(const char * filename)
   lastPhase = -1;
   numGvars = GetCurrentFirmware()->getCapability(Gvars);
   numFlightModes = GetCurrentFirmware()->getCapability(FlightModes);
+  inputsSent = false;
+  outputsShown = false;
   simulator->start(filename);
   getValues();
   setupTimer();
@@ -789,7 +796,7 @@ void SimulatorDialog9X::getValues()
     }
   };
 
-  simulator->setValues(inputs);
+  sendInputs(inputs);
 }
 
 void SimulatorDialog9X::saveSwitches(void)
@@ -901,7 +908,7 @@ void SimulatorDialogTaranis::getValues()
     }
   };
 
-  simulator->setValues(inputs);
+  sendInputs(inputs);
 }
 
 void SimulatorDialogTaranis::saveSwitches(void)
@@ -944,6 +951,15 @@ void SimulatorDialogTaranis::restoreSwitches(void)
   ui->switchA->setValue(switchstatus & 0x3);
 }
 
+void SimulatorDialog::sendInputs(TxInputs & inputs)
+{
+  if (!inputsSent || inputs != lastInputs) {
+    simulator->setValues(inputs);
+    lastInputs = inputs;
+    inputsSent = true;
+  }
+}
+
 inline int chVal(int val)
 {
   return qMin(1024, qMax(-1024, val));
@@ -977,7 +993,7 @@ void SimulatorDialog::setValues()
   simulator->getTrims(trims);
 
   for (int i=0; i<GetCurrentFirmware()->getCapability(Outputs); i++) {
-    if (i < channelSliders.size()) {
+    if (i < channelSliders.size() && (!outputsShown || outputs.chans[i] != lastOutputs.chans[i])) {
       channelSliders[i]->setValue(chVal(outputs.chans[i]));
       channelValues[i]->setText(QString("%1").arg((qreal)outputs.chans[i]*100/1024, 0, 'f', 1));
     }
@@ -993,6 +1009,8 @@ void SimulatorDialog::setValues()
   QString CSWITCH_OFF = "QLabel { }";
 
   for (int i=0; i<GetCurrentFirmware()->getCapability(LogicalSwitches); i++) {
+    if (outputsShown && outputs.vsw[i] == lastOutputs.vsw[i])
+      continue;
     logicalSwitchLabels[i]->setStyleSheet(outputs.vsw[i] ? CSWITCH_ON : CSWITCH_OFF);
     if (!logicalSwitchLabels2.isEmpty()) {
       logicalSwitchLabels2[i]->setStyleSheet(outputs.vsw[i] ? CSWITCH_ON : CSWITCH_OFF);
@@ -1001,6 +1019,8 @@ void SimulatorDialog::setValues()
 
   for (unsigned int gv=0; gv<numGvars; gv++) {
     for (unsigned int fm=0; fm<numFlightModes; fm++) {
+      if (outputsShown && lastPhase == lastGvarsPhase && outputs.gvars[fm][gv] == lastOutputs.gvars[fm][gv])
+        continue;
       gvarValues[gv*numFlightModes+fm]->setText(QString((fm==lastPhase)?"<b>%1</b>":"%1").arg(outputs.gvars[fm][gv]));
     }
   }
@@ -1008,6 +1028,10 @@ void SimulatorDialog::setValues()
   if (outputs.beep) {
     beepVal = outputs.beep;
   }
+
+  lastOutputs = outputs;
+  lastGvarsPhase = lastPhase;
+  outputsShown = true;
 }
 
 void SimulatorDialog::setupSticks()
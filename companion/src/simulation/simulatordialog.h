@@ -96,6 +96,7 @@ class SimulatorDialog : public QDialog
     void resizeEvent(QResizeEvent *event  = 0);
 
     virtual void getValues() = 0;
+    void sendInputs(TxInputs & inputs);
     void setValues();
     void centerSticks();
 
@@ -106,6 +107,13 @@ class SimulatorDialog : public QDialog
 
     int beepVal;
 
+    // only the inputs and outputs which changed go through the simulator interface and the widgets
+    TxInputs lastInputs;
+    bool inputsSent;
+    TxOutputs lastOutputs;
+    bool outputsShown;
+    unsigned int lastGvarsPhase;
+
     int lcdWidth;
     int lcdHeight;
     int lcdDepth;
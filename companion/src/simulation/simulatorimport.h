@@ -66,6 +66,8 @@ for (int i=0; i<NUM_LOGICAL_SWITCH; i++)
 #else
   outputs.vsw[i] = getSwitch(SWSRC_SW1+i, 0);
 #endif
+for (int i=0; i<TIMERS; i++)
+  outputs.timers[i] = timersStates[i].val;
 #ifdef GVAR_VALUE // defined(GVARS)
 /* TODO it could be a good idea instead of getPhase() / getPhaseName() outputs.phase = getFlightMode(); */
 #if defined(GVARS)
@@ -83,6 +85,11 @@ for (int fm=0; fm<MAX_FLIGHT_MODES; fm++) {
 if (lcd_refresh) {
   lightEnable = isBacklightEnable();
   lcd_refresh = false;
+  if (!lcdGetDamage(firstRow, lastRow)) {
+    // same frame again
+    firstRow = 0;
+    lastRow = -1;
+  }
   return true;
 }
 return false;
@@ -19,6 +19,7 @@
 
 #include "constants.h"
 #include <inttypes.h>
+#include <string.h>
 #include <QString>
 #include <QByteArray>
 #include <QMap>
@@ -40,6 +41,13 @@ struct TxInputs
     bool keys[C9X_NUM_KEYS];
     bool rotenc;
     bool trims[8];
+
+    bool operator != (const TxInputs & other) const
+    {
+      return memcmp(sticks, other.sticks, sizeof(sticks)) || memcmp(pots, other.pots, sizeof(pots)) ||
+             memcmp(switches, other.switches, sizeof(switches)) || memcmp(keys, other.keys, sizeof(keys)) ||
+             rotenc != other.rotenc || memcmp(trims, other.trims, sizeof(trims));
+    }
 };
 
 class TxOutputs
@@ -48,6 +56,7 @@ class TxOutputs
     TxOutputs() { memset(this, 0, sizeof(TxOutputs)); }
     int chans[C9X_NUM_CHNOUT];
     bool vsw[C9X_NUM_CSW];
+    int timers[C9X_MAX_TIMERS];
     int gvars[C9X_MAX_FLIGHT_MODES][C9X_MAX_GVARS];
     unsigned int beep;
     // uint8_t phase;
@@ -75,11 +84,17 @@ class SimulatorInterface
 
     virtual void stop() = 0;
 
+    // no firmware thread, the caller runs each 10ms period with step()
+    virtual bool startLockstep(QByteArray &eeprom) = 0;
+
+    virtual bool step() = 0;
+
     virtual bool timer10ms() = 0;
 
     virtual uint8_t * getLcd() = 0;
 
-    virtual bool lcdChanged(bool &lightEnable) = 0;
+    // the rows between firstRow and lastRow changed since the previous call (none when firstRow > lastRow)
+    virtual bool lcdChanged(bool &lightEnable, int &firstRow, int &lastRow) = 0;
 
     virtual void setValues(TxInputs &inputs) = 0;
 
@@ -0,0 +1,229 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "simulatorrunner.h"
+#include <QFile>
+#include <QStringList>
+#include "radio/src/telemetry/frsky.h"
+
+bool generateSportPacket(uint8_t * packet, uint8_t dataId, uint8_t prim, uint16_t appId, uint32_t data);
+
+bool SimulatorRunner::eventBefore(const Event & e1, const Event & e2)
+{
+  return e1.time < e2.time;
+}
+
+SimulatorRunner::SimulatorRunner(SimulatorInterface * simulator, int channels, int logicalSwitches, int timers):
+  simulator(simulator),
+  channels(std::min(channels, C9X_NUM_CHNOUT)),
+  logicalSwitches(std::min(logicalSwitches, C9X_NUM_CSW)),
+  timers(std::min(timers, C9X_MAX_TIMERS))
+{
+}
+
+bool SimulatorRunner::parseEvent(const QStringList & fields, Event & event)
+{
+  static const char * const names[] = { "stick", "pot", "switch", "key", "trim", "trainer", "sport", "end" };
+  static const int argsCount[] = { 2, 2, 2, 2, 2, 2, 3, 0 };
+
+  bool ok;
+  event.time = fields[0].toUInt(&ok);
+  if (!ok || fields.size() < 2)
+    return false;
+
+  for (int type=EVENT_STICK; type<=EVENT_END; type++) {
+    if (fields[1] == names[type]) {
+      if (fields.size() != 2 + argsCount[type])
+        return false;
+      event.type = EventType(type);
+      event.index = (argsCount[type] > 0 ? fields[2].toInt(&ok, 0) : 0);
+      if (!ok)
+        return false;
+      if (type == EVENT_SPORT) {
+        event.appId = fields[3].toUInt(&ok, 0);
+        if (ok) event.value = fields[4].toInt(&ok, 0);
+      }
+      else {
+        event.value = (argsCount[type] > 1 ? fields[3].toInt(&ok, 0) : 0);
+      }
+      return ok;
+    }
+  }
+
+  return false;
+}
+
+bool SimulatorRunner::loadTimeline(const QString & filename)
+{
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    error = QObject::tr("Cannot open %1: %2").arg(filename).arg(file.errorString());
+    return false;
+  }
+
+  timeline.clear();
+  int lineNumber = 0;
+  QTextStream stream(&file);
+  while (!stream.atEnd()) {
+    QString line = stream.readLine();
+    lineNumber++;
+    int comment = line.indexOf('#');
+    if (comment >= 0)
+      line.truncate(comment);
+    QStringList fields = line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+    if (fields.isEmpty())
+      continue;
+    Event event;
+    if (!parseEvent(fields, event)) {
+      error = QObject::tr("%1:%2: invalid event \"%3\"").arg(filename).arg(lineNumber).arg(line.trimmed());
+      return false;
+    }
+    timeline.append(event);
+  }
+
+  // events at the same time keep their file order
+  qStableSort(timeline.begin(), timeline.end(), eventBefore);
+  return true;
+}
+
+bool SimulatorRunner::applyEvent(const Event & event, TxInputs & inputs)
+{
+  switch (event.type) {
+    case EVENT_STICK:
+      if (event.index < 0 || event.index >= NUM_STICKS)
+        return false;
+      inputs.sticks[event.index] = LIMIT(-1024, event.value, 1024);
+      break;
+    case EVENT_POT:
+      if (event.index < 0 || event.index >= C9X_NUM_POTS)
+        return false;
+      inputs.pots[event.index] = LIMIT(-1024, event.value, 1024);
+      break;
+    case EVENT_SWITCH:
+      if (event.index < 0 || event.index >= C9X_NUM_SWITCHES)
+        return false;
+      inputs.switches[event.index] = LIMIT(-1, event.value, 1);
+      break;
+    case EVENT_KEY:
+      if (event.index < 0 || event.index >= C9X_NUM_KEYS)
+        return false;
+      inputs.keys[event.index] = event.value;
+      break;
+    case EVENT_TRIM:
+      if (event.index < 0 || event.index >= 8)
+        return false;
+      inputs.trims[event.index] = event.value;
+      break;
+    case EVENT_TRAINER:
+      simulator->setTrainerInput(event.index, event.value);
+      break;
+    case EVENT_SPORT:
+    {
+      uint8_t packet[FRSKY_SPORT_PACKET_SIZE];
+      if (!generateSportPacket(packet, event.index - 1, DATA_FRAME, event.appId, event.value))
+        return false;
+      simulator->sendTelemetry(packet, FRSKY_SPORT_PACKET_SIZE);
+      break;
+    }
+    default:
+      break;
+  }
+  return true;
+}
+
+void SimulatorRunner::writeTraceHeader(QTextStream & trace)
+{
+  trace << "time";
+  for (int i=0; i<channels; i++)
+    trace << ",CH" << i+1;
+  for (int i=0; i<logicalSwitches; i++)
+    trace << ",L" << i+1;
+  for (int i=0; i<timers; i++)
+    trace << ",T" << i+1;
+  trace << endl;
+}
+
+void SimulatorRunner::writeTraceLine(QTextStream & trace, unsigned int time, const TxOutputs & outputs)
+{
+  trace << time;
+  for (int i=0; i<channels; i++)
+    trace << "," << outputs.chans[i];
+  for (int i=0; i<logicalSwitches; i++)
+    trace << "," << (outputs.vsw[i] ? 1 : 0);
+  for (int i=0; i<timers; i++)
+    trace << "," << outputs.timers[i];
+  trace << "\n";
+}
+
+bool SimulatorRunner::run(QByteArray & eeprom, QTextStream & trace, unsigned int duration, unsigned int tracePeriod)
+{
+  for (int i=0; i<timeline.size(); i++) {
+    if (timeline[i].type == EVENT_END) {
+      duration = timeline[i].time;
+      break;
+    }
+  }
+
+  if (tracePeriod < 10)
+    tracePeriod = 10;
+
+  TxInputs inputs;
+  memset(&inputs, 0, sizeof(inputs));
+  TxOutputs outputs;
+
+  if (!simulator->startLockstep(eeprom)) {
+    error = QObject::tr("Firmware error: %1").arg(simulator->getError());
+    simulator->stop();
+    return false;
+  }
+
+  writeTraceHeader(trace);
+
+  int next = 0;
+  unsigned int nextTrace = 0;
+  bool result = true;
+  for (unsigned int time=0; time<=duration; time+=10) {
+    bool changed = false;
+    while (next < timeline.size() && timeline[next].time <= time) {
+      if (!applyEvent(timeline[next], inputs)) {
+        error = QObject::tr("Invalid index in event at %1ms").arg(timeline[next].time);
+        result = false;
+        break;
+      }
+      changed = true;
+      next++;
+    }
+    if (!result)
+      break;
+
+    if (changed || time == 0) {
+      simulator->setValues(inputs);
+    }
+
+    if (!simulator->step()) {
+      error = QObject::tr("Firmware error at %1ms: %2").arg(time).arg(simulator->getError());
+      result = false;
+      break;
+    }
+
+    // the time goes by steps of 10ms, a period which isn't a multiple of 10ms is traced at the first step after it
+    if (time >= nextTrace) {
+      simulator->getValues(outputs);
+      writeTraceLine(trace, time, outputs);
+      nextTrace += tracePeriod;
+    }
+  }
+
+  trace.flush();
+  simulator->stop();
+  return result;
+}
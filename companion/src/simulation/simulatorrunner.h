@@ -0,0 +1,82 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef simulatorrunner_h
+#define simulatorrunner_h
+
+#include <QList>
+#include <QString>
+#include <QTextStream>
+#include "simulatorinterface.h"
+
+/*
+ * Headless simulation: runs the firmware in lockstep (one 10ms period per step,
+ * as fast as the CPU allows), applies a scripted input timeline and writes the
+ * channels, logical switches and timers to a CSV trace.
+ *
+ * Timeline file, one event per line, '#' starts a comment:
+ *   <time ms> stick <index> <value -1024..1024>
+ *   <time ms> pot <index> <value -1024..1024>
+ *   <time ms> switch <index> <-1|0|1>
+ *   <time ms> key <index> <0|1>
+ *   <time ms> trim <index> <0|1>
+ *   <time ms> trainer <index> <value -512..512>
+ *   <time ms> sport <instance> <appId> <value>
+ *   <time ms> end
+ */
+class SimulatorRunner
+{
+  public:
+    SimulatorRunner(SimulatorInterface * simulator, int channels, int logicalSwitches, int timers);
+
+    bool loadTimeline(const QString & filename);
+
+    // duration is only used when the timeline has no 'end' event
+    bool run(QByteArray & eeprom, QTextStream & trace, unsigned int duration, unsigned int tracePeriod);
+
+    QString errorString() const { return error; }
+
+  private:
+    enum EventType {
+      EVENT_STICK,
+      EVENT_POT,
+      EVENT_SWITCH,
+      EVENT_KEY,
+      EVENT_TRIM,
+      EVENT_TRAINER,
+      EVENT_SPORT,
+      EVENT_END
+    };
+
+    struct Event {
+      unsigned int time;
+      EventType type;
+      int index;
+      int value;
+      unsigned int appId;
+    };
+
+    SimulatorInterface * simulator;
+    int channels;
+    int logicalSwitches;
+    int timers;
+    QList<Event> timeline;
+    QString error;
+
+    static bool eventBefore(const Event & e1, const Event & e2);
+    bool parseEvent(const QStringList & fields, Event & event);
+    bool applyEvent(const Event & event, TxInputs & inputs);
+    void writeTraceHeader(QTextStream & trace);
+    void writeTraceLine(QTextStream & trace, unsigned int time, const TxOutputs & outputs);
+};
+
+#endif
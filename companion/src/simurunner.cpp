@@ -0,0 +1,115 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include "simulation/simulatorrunner.h"
+#include "eeprominterface.h"
+#include "qxtcommandoptions.h"
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+  app.setApplicationName("OpenTX Simulator Runner");
+  app.setOrganizationName("OpenTX");
+  app.setOrganizationDomain("open-tx.org");
+
+  QTextStream err(stderr);
+
+  registerSimulators();
+  registerOpenTxFirmwares();
+
+  QxtCommandOptions options;
+  options.add("radio", "radio to simulate", QxtCommandOptions::ValueRequired);
+  options.alias("radio", "r");
+  options.add("timeline", "input timeline file", QxtCommandOptions::ValueRequired);
+  options.alias("timeline", "t");
+  options.add("output", "trace output file (default: stdout)", QxtCommandOptions::ValueRequired);
+  options.alias("output", "o");
+  options.add("duration", "simulated time in ms when the timeline has no 'end' event (default: 10000)", QxtCommandOptions::ValueRequired);
+  options.add("period", "trace period in ms (default: 10)", QxtCommandOptions::ValueRequired);
+  options.add("sdpath", "SD card directory", QxtCommandOptions::ValueRequired);
+  options.add("help", "show this help text");
+  options.alias("help", "h");
+  options.parse(QCoreApplication::arguments());
+
+  if (options.count("help") || options.showUnrecognizedWarning() || options.positional().size() != 1 || options.count("radio") != 1) {
+    err << "Usage: simurunner --radio <radio> [OPTION]... <EEPROM.BIN FILE>" << endl << endl;
+    err << "Options:" << endl;
+    options.showUsage(false, err);
+    err << endl << "Available radios:" << endl;
+    foreach(SimulatorFactory * factory, registered_simulators) {
+      err << "\t" << factory->name() << endl;
+    }
+    return 1;
+  }
+
+  QString firmwareId = options.value("radio").toString();
+  SimulatorFactory * factory = getSimulatorFactory(firmwareId);
+  if (!factory) {
+    err << "ERROR: Simulator " << firmwareId << " not found" << endl;
+    return 2;
+  }
+  current_firmware_variant = GetFirmware(factory->name());
+
+  QFile eepromFile(options.positional()[0]);
+  if (!eepromFile.open(QIODevice::ReadOnly)) {
+    err << "ERROR: Cannot open " << eepromFile.fileName() << ": " << eepromFile.errorString() << endl;
+    return 2;
+  }
+  QByteArray eeprom = eepromFile.readAll();
+
+  SimulatorInterface * simulator = factory->create();
+  if (options.count("sdpath")) {
+    simulator->setSdPath(options.value("sdpath").toString());
+  }
+
+  SimulatorRunner runner(simulator, current_firmware_variant->getCapability(Outputs),
+                         current_firmware_variant->getCapability(LogicalSwitches),
+                         current_firmware_variant->getCapability(Timers));
+
+  if (options.count("timeline") && !runner.loadTimeline(options.value("timeline").toString())) {
+    err << "ERROR: " << runner.errorString() << endl;
+    delete simulator;
+    return 2;
+  }
+
+  QFile outputFile;
+  if (options.count("output")) {
+    outputFile.setFileName(options.value("output").toString());
+    if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+      err << "ERROR: Cannot open " << outputFile.fileName() << ": " << outputFile.errorString() << endl;
+      delete simulator;
+      return 2;
+    }
+  }
+  else {
+    outputFile.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+  }
+  QTextStream trace(&outputFile);
+
+  unsigned int duration = options.count("duration") ? options.value("duration").toUInt() : 10000;
+  unsigned int period = options.count("period") ? options.value("period").toUInt() : 10;
+
+  int result = 0;
+  if (!runner.run(eeprom, trace, duration, period)) {
+    err << "ERROR: " << runner.errorString() << endl;
+    result = 3;
+  }
+
+  delete simulator;
+  unregisterSimulators();
+  unregisterOpenTxFirmwares();
+
+  return result;
+}
@@ -0,0 +1,104 @@
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <utime.h>
+#include "process_sync.h"
+#include "progresswidget.h"
+
+class SyncTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void init();
+    void cleanup();
+    void secondSyncUsesTheManifest();
+
+  private:
+    void writeFile(const QString & path, const QByteArray & data, uint lastModified);
+    QByteArray readFile(const QString & path);
+    void sync();
+    QString base;
+    QString folder1;
+    QString folder2;
+};
+
+void SyncTest::init()
+{
+  base = QDir::tempPath() + QString("/companion-synctest-%1").arg(QCoreApplication::applicationPid());
+  folder1 = base + "/folder1";
+  folder2 = base + "/folder2";
+  QVERIFY(QDir().mkpath(folder1));
+  QVERIFY(QDir().mkpath(folder2));
+  // the manifest is written in the data location, kept out of the user one
+  qputenv("XDG_DATA_HOME", QFile::encodeName(base + "/data"));
+}
+
+static void removeTree(const QString & path)
+{
+  QDir dir(path);
+  foreach (const QFileInfo & info, dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden)) {
+    if (info.isDir())
+      removeTree(info.absoluteFilePath());
+    else
+      QFile::remove(info.absoluteFilePath());
+  }
+  dir.rmdir(path);
+}
+
+void SyncTest::cleanup()
+{
+  removeTree(base);
+}
+
+void SyncTest::writeFile(const QString & path, const QByteArray & data, uint lastModified)
+{
+  QFile file(path);
+  QVERIFY(file.open(QFile::WriteOnly | QIODevice::Truncate));
+  QCOMPARE(file.write(data), (qint64)data.size());
+  file.close();
+  struct utimbuf times = { (time_t)lastModified, (time_t)lastModified };
+  QCOMPARE(utime(QFile::encodeName(path).constData(), &times), 0);
+}
+
+QByteArray SyncTest::readFile(const QString & path)
+{
+  QFile file(path);
+  if (!file.open(QFile::ReadOnly))
+    return QByteArray();
+  return file.readAll();
+}
+
+void SyncTest::sync()
+{
+  ProgressWidget progress(NULL);
+  SyncProcess syncProcess(folder1, folder2, &progress);
+  syncProcess.run();
+}
+
+// A file the synchronization copied is not read again by the next one: its destination is
+// changed behind the manifest back (same size, same date), the second synchronization still
+// takes both files as identical and doesn't copy anything
+void SyncTest::secondSyncUsesTheManifest()
+{
+  QByteArray contents = QByteArray("0123456789").repeated(1000);
+  uint yesterday = QDateTime::currentDateTime().toTime_t() - 24*3600;
+  writeFile(folder1 + "/model.bin", contents, yesterday);
+
+  sync();
+  QCOMPARE(readFile(folder2 + "/model.bin"), contents);
+
+  QByteArray changed = contents;
+  changed[0] = 'X';
+  uint copied = QFileInfo(folder2 + "/model.bin").lastModified().toTime_t();
+  writeFile(folder2 + "/model.bin", changed, copied);
+
+  sync();
+  QCOMPARE(readFile(folder1 + "/model.bin"), contents);
+  QCOMPARE(readFile(folder2 + "/model.bin"), changed);
+}
+
+QTEST_MAIN(SyncTest)
+#include "synctest.moc"
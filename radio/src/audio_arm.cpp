@@ -527,7 +527,20 @@ void audioTask(void* pdata)
 #endif  
 
   while (1) {
+    __disable_irq();
+    uint16_t t0 = getTmr2MHz();
+    tmr10ms_t t10ms = get_tmr10ms();
+    uint32_t preemption = menusTaskPreemption;
+    __enable_irq();
+
     audioQueue.wakeup();
+
+    // the mixer runs meanwhile are already part of this duration
+    uint32_t duration = getDurationTmr2MHz(t0, t10ms);
+    __disable_irq();
+    menusTaskPreemption = preemption + duration;
+    __enable_irq();
+
     CoTickDelay(2/*4ms*/);
   }
 }
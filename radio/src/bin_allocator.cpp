@@ -6,6 +6,8 @@
 
 BinAllocator_slots1 slots1;
 BinAllocator_slots2 slots2;
+BinAllocator_slots3 slots3;
+unsigned int binAllocatorFallbacks = 0;
 
 #if defined(DEBUG)
 int SimulateMallocFailure = 0;    //set this to simulate allocation failure
@@ -14,13 +16,33 @@ int SimulateMallocFailure = 0;    //set this to simulate allocation failure
 bool bin_free(void * ptr)
 {
   //return TRUE if ours
-  return slots1.free(ptr) || slots2.free(ptr);
+  return slots1.free(ptr) || slots2.free(ptr) || slots3.free(ptr);
 }
 
 void * bin_malloc(size_t size) {
-  //try to allocate from our space
+  //try to allocate from our space, in the smallest slots first
   void * res = slots1.malloc(size);
-  return res ? res : slots2.malloc(size);
+  if (!res) res = slots2.malloc(size);
+  if (!res) res = slots3.malloc(size);
+  return res;
+}
+
+size_t bin_size(void * ptr)
+{
+  return slots1.size(ptr) + slots2.size(ptr) + slots3.size(ptr);
+}
+
+template <class T> void dumpBinAllocatorSlots(T & slots, void (*print)(const char * format, ...))
+{
+  print("%d bytes slots: %d/%d used, peak %d, %d overflows\r\n", slots.slot_size(), slots.size(), slots.capacity(), slots.peak(), slots.overflows());
+}
+
+void dumpBinAllocatorStats(void (*print)(const char * format, ...))
+{
+  dumpBinAllocatorSlots(slots1, print);
+  dumpBinAllocatorSlots(slots2, print);
+  dumpBinAllocatorSlots(slots3, print);
+  print("%d allocations in libc heap\r\n", binAllocatorFallbacks);
 }
 
 void * bin_realloc(void * ptr, size_t size)
@@ -30,7 +52,7 @@ void * bin_realloc(void * ptr, size_t size)
     return bin_malloc(size);
   }
   else {
-    if (! (slots1.is_member(ptr) || slots2.is_member(ptr)) ) {
+    if (! (slots1.is_member(ptr) || slots2.is_member(ptr) || slots3.is_member(ptr)) ) {
       // not our data, leave it to libc realloc
       return 0;
     }
@@ -46,6 +68,10 @@ void * bin_realloc(void * ptr, size_t size)
       // TRACE("OUR realloc %p[%lu] fits in slot2", ptr, size);
       return ptr;
     }
+    if ( slots3.can_fit(ptr, size) ) {
+      // TRACE("OUR realloc %p[%lu] fits in slot3", ptr, size);
+      return ptr;
+    }
 
     //we need a bigger slot
     void * res = bin_malloc(size);
@@ -57,9 +83,10 @@ void * bin_realloc(void * ptr, size_t size)
         TRACE("libc malloc [%lu] FAILURE", size);  
         return 0;
       }
+      ++binAllocatorFallbacks;
     }
     //copy data
-    memcpy(res, ptr, slots1.size(ptr) + slots2.size(ptr));
+    memcpy(res, ptr, bin_size(ptr));
     bin_free(ptr);
     return res;
   }
@@ -99,6 +126,9 @@ void *bin_l_alloc (void *ud, void *ptr, size_t osize, size_t nsize)
       // TRACE("OUR realloc %p[%lu] -> %p[%lu]", ptr, osize, res, nsize); 
     }
     if (res == 0) {
+      if (ptr == 0) {
+        ++binAllocatorFallbacks;
+      }
       res = realloc(ptr, nsize);
       // TRACE("libc realloc %p[%lu] -> %p[%lu]", ptr, osize, res, nsize);
       // if (res == 0 ){
@@ -3,51 +3,57 @@
 
 #include "debug.h"
 
+// Fixed size slots kept in an intrusive list of free slots, so that malloc() and free() are O(1)
 template <int SIZE_SLOT, int NUM_BINS> class BinAllocator {
 private:
-  PACK(struct Bin {
+  union Bin {
     char data[SIZE_SLOT];
-    bool Used;
-  });
-  struct Bin Bins[NUM_BINS];
+    Bin * next;           // next free slot, only valid while the slot is free
+  };
+  Bin Bins[NUM_BINS];
+  Bin * FreeBins;
   int NoUsedBins;
+  int PeakUsedBins;
+  int Overflows;          // allocations which found all the slots used and went to larger slots or the heap
 public:
-  BinAllocator() : NoUsedBins(0) {
-    memclear(Bins, sizeof(Bins));
+  BinAllocator() : FreeBins(Bins), NoUsedBins(0), PeakUsedBins(0), Overflows(0) {
+    for (int n = 0; n < NUM_BINS-1; ++n) {
+      Bins[n].next = &Bins[n+1];
+    }
+    Bins[NUM_BINS-1].next = 0;
   }
   bool free(void * ptr) {
-    for (size_t n = 0; n < NUM_BINS; ++n) {
-      if (ptr == Bins[n].data) {
-        Bins[n].Used = false;
-        --NoUsedBins;
-        // TRACE("\tBinAllocator<%d> free %lu ------", SIZE_SLOT, n);
-        return true;
-      }
+    if (!is_member(ptr)) {
+      return false;
     }
-    return false;
+    // the pointers we give away are always the start of a slot
+    Bin * bin = (Bin *)ptr;
+    bin->next = FreeBins;
+    FreeBins = bin;
+    --NoUsedBins;
+    // TRACE("\tBinAllocator<%d> free %d ------", SIZE_SLOT, bin - Bins);
+    return true;
   }
   bool is_member(void * ptr) {
-    return (ptr >= Bins[0].data && ptr <= Bins[NUM_BINS-1].data);
+    return ((Bin *)ptr >= Bins && (Bin *)ptr < Bins + NUM_BINS);
   }
   void * malloc(size_t size) {
     if (size > SIZE_SLOT) {
       // TRACE("BinAllocator<%d> malloc [%lu] size > SIZE_SLOT", SIZE_SLOT, size);
       return 0;
     }
-    if (NoUsedBins >= NUM_BINS) {
+    Bin * bin = FreeBins;
+    if (!bin) {
       // TRACE("BinAllocator<%d> malloc [%lu] no free slots", SIZE_SLOT, size);
+      ++Overflows;
       return 0;
     }
-    for (size_t n = 0; n < NUM_BINS; ++n) {
-      if (!Bins[n].Used) {
-        Bins[n].Used = true;
-        ++NoUsedBins;
-        // TRACE("\tBinAllocator<%d> malloc %lu[%lu]", SIZE_SLOT, n, size);
-        return Bins[n].data;
-      }
+    FreeBins = bin->next;
+    if (++NoUsedBins > PeakUsedBins) {
+      PeakUsedBins = NoUsedBins;
     }
-    // TRACE("BinAllocator<%d> malloc [%lu] no free slots", SIZE_SLOT , size);
-    return 0;
+    // TRACE("\tBinAllocator<%d> malloc %d[%lu]", SIZE_SLOT, bin - Bins, size);
+    return bin->data;
   }
   size_t size(void * ptr) {
     return is_member(ptr) ? SIZE_SLOT : 0;
@@ -55,21 +61,32 @@ public:
   bool can_fit(void * ptr, size_t size) {
     return is_member(ptr) && size <= SIZE_SLOT;  //todo is_member check is redundant
   }
+  unsigned int slot_size() { return SIZE_SLOT; }
   unsigned int capacity() { return NUM_BINS; }
   unsigned int size() { return NoUsedBins; }
+  unsigned int peak() { return PeakUsedBins; }
+  unsigned int overflows() { return Overflows; }
 };
 
+// Slot sizes follow the Lua 5.2 objects on a 32 bits target: short strings, closures and upvalues fit
+// in the smallest slots, tables and hash nodes in the medium ones, small arrays and prototypes in the largest
 #if defined(SIMU)
-typedef BinAllocator<39,300> BinAllocator_slots1;
-typedef BinAllocator<79,100> BinAllocator_slots2;
+typedef BinAllocator<32,300> BinAllocator_slots1;
+typedef BinAllocator<48,150> BinAllocator_slots2;
+typedef BinAllocator<96,100> BinAllocator_slots3;
 #else
-typedef BinAllocator<29,200> BinAllocator_slots1;
-typedef BinAllocator<91,50> BinAllocator_slots2;
+typedef BinAllocator<32,150> BinAllocator_slots1;
+typedef BinAllocator<48,70> BinAllocator_slots2;
+typedef BinAllocator<96,24> BinAllocator_slots3;
 #endif
 
 #if defined(USE_BIN_ALLOCATOR)
 extern BinAllocator_slots1 slots1;
 extern BinAllocator_slots2 slots2;
+extern BinAllocator_slots3 slots3;
+extern unsigned int binAllocatorFallbacks;    // allocations which had to use the libc heap
+
+void dumpBinAllocatorStats(void (*print)(const char * format, ...));
 
 // wrapper for our BinAllocator for Lua
 void *bin_l_alloc (void *ud, void *ptr, size_t osize, size_t nsize);
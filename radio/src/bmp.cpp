@@ -36,12 +36,18 @@
 
 #include "opentx.h"
 
-const pm_char * bmpLoad(uint8_t *bmp, const char *filename, const unsigned int width, const unsigned int height)
+struct BmpInfo {
+  uint32_t w;
+  uint32_t h;
+  uint16_t depth;
+  uint8_t palette[16];
+};
+
+// opens the file and reads the header, the file is left open at the pixels on success
+static const pm_char * bmpOpen(FIL & bmpFile, BmpInfo & info, const char *filename, const unsigned int width, const unsigned int height)
 {
-  FIL bmpFile;
   UINT read;
-  uint8_t palette[16];
-  uint8_t bmpBuf[LCD_W]; /* maximum with LCD_W */
+  uint8_t bmpBuf[64];
   uint8_t *buf = &bmpBuf[0];
 
   if (width > LCD_W) {
@@ -97,7 +103,8 @@ const pm_char * bmpLoad(uint8_t *bmp, const char *filename, const unsigned int w
     return STR_INCOMPATIBLE;
   }
 
-  uint32_t w, h;
+  uint32_t & w = info.w;
+  uint32_t & h = info.h;
 
   switch (ihsize){
     case  40: // windib
@@ -129,7 +136,7 @@ const pm_char * bmpLoad(uint8_t *bmp, const char *filename, const unsigned int w
     return STR_INCOMPATIBLE;
   }
 
-  uint16_t depth = *((uint16_t *)&buf[2]);
+  uint16_t depth = info.depth = *((uint16_t *)&buf[2]);
 
   buf = &bmpBuf[0];
 
@@ -139,7 +146,7 @@ const pm_char * bmpLoad(uint8_t *bmp, const char *filename, const unsigned int w
       return SDCARD_ERROR(result);
     }
     for (uint8_t i=0; i<16; i++) {
-      palette[i] = buf[4*i] >> 4;
+      info.palette[i] = buf[4*i] >> 4;
     }
   }
   else {
@@ -149,6 +156,20 @@ const pm_char * bmpLoad(uint8_t *bmp, const char *filename, const unsigned int w
     }
   }
 
+  return 0;
+}
+
+// reads the pixels and closes the file
+static const pm_char * bmpRead(FIL & bmpFile, const BmpInfo & info, uint8_t *bmp)
+{
+  FRESULT result;
+  UINT read;
+  uint32_t w = info.w;
+  uint32_t h = info.h;
+  const uint8_t * palette = info.palette;
+  uint8_t bmpBuf[LCD_W]; /* maximum with LCD_W */
+  uint8_t *buf = &bmpBuf[0];
+
   uint8_t *dest = bmp;
 
   *dest++ = w;
@@ -158,7 +179,7 @@ const pm_char * bmpLoad(uint8_t *bmp, const char *filename, const unsigned int w
 
   uint32_t rowSize;
 
-  switch (depth) {
+  switch (info.depth) {
     case 1:
       rowSize = ((w+31)/32)*4;
       for (uint32_t i=0; i<h; i+=2) {
@@ -204,6 +225,124 @@ const pm_char * bmpLoad(uint8_t *bmp, const char *filename, const unsigned int w
   return 0;
 }
 
+const pm_char * bmpLoad(uint8_t *bmp, const char *filename, const unsigned int width, const unsigned int height)
+{
+  FIL bmpFile;
+  BmpInfo info;
+
+  const pm_char * result = bmpOpen(bmpFile, info, filename, width, height);
+  if (result) {
+    return result;
+  }
+
+  return bmpRead(bmpFile, info, bmp);
+}
+
+/*
+ * Bitmaps already converted to the LCD format, kept in RAM so that Lua
+ * scripts drawing the same pixmaps on every frame and the models list don't
+ * go back to the SD card. Each entry stores the file name followed by the
+ * bitmap in the pool, the entries are kept in the pool order. The bitmap size
+ * is taken from the file header, and when the pool or the entries are full
+ * the least recently used entries are evicted one by one, the following ones
+ * being moved down. A returned bitmap is thus only valid until the next call.
+ * Load errors are not cached, the file may be added later. The cache is
+ * flushed when the SD card is unmounted and when the Lua scripts are
+ * reloaded, the only moments where the files could have changed.
+ */
+#define BITMAP_CACHE_SIZE     5120
+#define BITMAP_CACHE_ENTRIES  12
+
+struct BitmapCacheEntry {
+  uint16_t offset;
+  uint16_t size;        // file name + bitmap
+  uint8_t width;
+  uint8_t height;
+  uint16_t lastUsed;
+};
+
+static uint8_t bitmapCachePool[BITMAP_CACHE_SIZE];
+static BitmapCacheEntry bitmapCache[BITMAP_CACHE_ENTRIES];
+static uint16_t bitmapCachePoolUsed = 0;
+static uint8_t bitmapCacheCount = 0;
+static uint16_t bitmapCacheClock = 0;
+
+void bmpCacheClear()
+{
+  bitmapCachePoolUsed = 0;
+  bitmapCacheCount = 0;
+}
+
+static void bmpCacheEvictOldest()
+{
+  uint8_t oldest = 0;
+  for (uint8_t i=1; i<bitmapCacheCount; i++) {
+    // the clock may wrap, the ages are compared rather than the dates
+    if ((uint16_t)(bitmapCacheClock - bitmapCache[i].lastUsed) > (uint16_t)(bitmapCacheClock - bitmapCache[oldest].lastUsed)) {
+      oldest = i;
+    }
+  }
+
+  uint16_t offset = bitmapCache[oldest].offset;
+  uint16_t size = bitmapCache[oldest].size;
+  memmove(&bitmapCachePool[offset], &bitmapCachePool[offset + size], bitmapCachePoolUsed - offset - size);
+  bitmapCachePoolUsed -= size;
+  bitmapCacheCount--;
+  for (uint8_t i=oldest; i<bitmapCacheCount; i++) {
+    bitmapCache[i] = bitmapCache[i+1];
+    bitmapCache[i].offset -= size;
+  }
+}
+
+const uint8_t * bmpLoadCached(const char *filename, const unsigned int width, const unsigned int height)
+{
+  for (uint8_t i=0; i<bitmapCacheCount; i++) {
+    BitmapCacheEntry & entry = bitmapCache[i];
+    const char * name = (const char *)&bitmapCachePool[entry.offset];
+    if (entry.width == width && entry.height == height && !strcmp(name, filename)) {
+      entry.lastUsed = ++bitmapCacheClock;
+      return (const uint8_t *)(name + strlen(name) + 1);
+    }
+  }
+
+  if (width > 255 || height > 255) {
+    return NULL;
+  }
+
+  FIL bmpFile;
+  BmpInfo info;
+  if (bmpOpen(bmpFile, info, filename, width, height)) {
+    return NULL;
+  }
+
+  unsigned int len = strlen(filename) + 1;
+  unsigned int needed = len + BITMAP_BUFFER_SIZE(info.w, info.h);
+  if (needed > BITMAP_CACHE_SIZE) {
+    f_close(&bmpFile);
+    return NULL;
+  }
+
+  while (bitmapCacheCount == BITMAP_CACHE_ENTRIES || bitmapCachePoolUsed + needed > BITMAP_CACHE_SIZE) {
+    bmpCacheEvictOldest();
+  }
+
+  BitmapCacheEntry & entry = bitmapCache[bitmapCacheCount];
+  entry.offset = bitmapCachePoolUsed;
+  entry.size = needed;
+  entry.width = width;
+  entry.height = height;
+  entry.lastUsed = ++bitmapCacheClock;
+  memcpy(&bitmapCachePool[entry.offset], filename, len);
+  uint8_t * bitmap = &bitmapCachePool[entry.offset + len];
+  if (bmpRead(bmpFile, info, bitmap)) {
+    return NULL;
+  }
+
+  bitmapCacheCount++;
+  bitmapCachePoolUsed += needed;
+  return bitmap;
+}
+
 const uint8_t bmpHeader[] = {
   0x42, 0x4d, 0xF8, 0x1A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x76, 0x00, 0x00, 0x00, 0x28, 0x00,
   0x00, 0x00, 212,  0x00, 0x00, 0x00, 64,   0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00,
@@ -35,15 +35,46 @@
  */
 
 #include "opentx.h"
+#include "bin_allocator.h"
 #include <ctype.h>
 
 #define CLI_COMMAND_MAX_ARGS           8
 #define CLI_COMMAND_MAX_LEN            256
 
+/*
+ * Binary stream frame, all values little endian:
+ *   sync       2 bytes  0xA5 0x5A
+ *   mask       1 byte   fields present in the payload (CLI_STREAM_xxx)
+ *   sequence   2 bytes  incremented for each frame, including dropped ones
+ *   time       4 bytes  g_tmr10ms
+ *   length     2 bytes  payload length
+ *   payload             fields in mask bits order:
+ *                         channels          NUM_CHNOUT x int16
+ *                         sticks            NUM_STICKS+NUM_POTS x int16 (calibrated)
+ *                         logical switches  NUM_LOGICAL_SWITCH bits
+ *                         telemetry         MAX_SENSORS x int32
+ *   crc        2 bytes  crc16() of everything after the sync bytes
+ */
+#define CLI_STREAM_SYNC1               0xA5
+#define CLI_STREAM_SYNC2               0x5A
+#define CLI_STREAM_HEADER_SIZE         11
+#if defined(FRSKY)
+  #define CLI_STREAM_TELEMETRY_SIZE    (MAX_SENSORS*4)
+#else
+  #define CLI_STREAM_TELEMETRY_SIZE    0
+#endif
+#define CLI_STREAM_PAYLOAD_MAX_SIZE    (NUM_CHNOUT*2 + (NUM_STICKS+NUM_POTS)*2 + (NUM_LOGICAL_SWITCH+7)/8 + CLI_STREAM_TELEMETRY_SIZE)
+#define CLI_STREAM_FRAME_MAX_SIZE      (CLI_STREAM_HEADER_SIZE + CLI_STREAM_PAYLOAD_MAX_SIZE + 2)
+
 OS_TID cliTaskId;
 TaskStack<CLI_STACK_SIZE> cliStack;
 Fifo<256> cliRxFifo;
 uint8_t cliTracesEnabled = false;
+uint8_t cliStreamMask = 0;
+uint16_t cliStreamSequence = 0;
+uint16_t cliStreamDropped = 0;
+volatile bool cliStreamResetRequest = false;
+Fifo<4096> cliStreamFifo;
 
 typedef int (* CliFunction) (const char ** args);
 
@@ -150,6 +181,131 @@ int cliTrace(const char ** argv)
   return 0;
 }
 
+// Called from the mixer task after each doMixerCalculations()
+void cliStreamFrame()
+{
+  static uint8_t frame[CLI_STREAM_FRAME_MAX_SIZE];
+  uint8_t mask = cliStreamMask;
+  uint8_t * p = &frame[CLI_STREAM_HEADER_SIZE];
+
+  // the counters are only written by the mixer task, the CLI task requests their reset
+  if (cliStreamResetRequest) {
+    cliStreamSequence = 0;
+    cliStreamDropped = 0;
+    cliStreamResetRequest = false;
+  }
+
+  if (mask & CLI_STREAM_CHANNELS) {
+    memcpy(p, channelOutputs, sizeof(channelOutputs));
+    p += sizeof(channelOutputs);
+  }
+
+  if (mask & CLI_STREAM_STICKS) {
+    memcpy(p, calibratedStick, sizeof(calibratedStick));
+    p += sizeof(calibratedStick);
+  }
+
+  if (mask & CLI_STREAM_LOGICAL_SWITCHES) {
+    memclear(p, (NUM_LOGICAL_SWITCH+7)/8);
+    for (int i=0; i<NUM_LOGICAL_SWITCH; i++) {
+      if (getSwitch(SWSRC_FIRST_LOGICAL_SWITCH+i)) {
+        p[i/8] |= (1 << (i%8));
+      }
+    }
+    p += (NUM_LOGICAL_SWITCH+7)/8;
+  }
+
+#if defined(FRSKY)
+  if (mask & CLI_STREAM_TELEMETRY) {
+    for (int i=0; i<MAX_SENSORS; i++) {
+      memcpy(p, &telemetryItems[i].value, sizeof(int32_t));
+      p += sizeof(int32_t);
+    }
+  }
+#endif
+
+  uint16_t length = p - &frame[CLI_STREAM_HEADER_SIZE];
+  uint32_t time = g_tmr10ms;
+  frame[0] = CLI_STREAM_SYNC1;
+  frame[1] = CLI_STREAM_SYNC2;
+  frame[2] = mask;
+  memcpy(&frame[3], &cliStreamSequence, sizeof(uint16_t));
+  memcpy(&frame[5], &time, sizeof(uint32_t));
+  memcpy(&frame[9], &length, sizeof(uint16_t));
+  uint16_t crc = crc16(&frame[2], p - &frame[2]);
+  memcpy(p, &crc, sizeof(uint16_t));
+  p += sizeof(uint16_t);
+
+  cliStreamSequence++;
+
+  // never wait here, a frame which doesn't fit is dropped (the host sees the sequence gap)
+  uint32_t size = p - frame;
+  if (cliStreamFifo.space() < size) {
+    cliStreamDropped++;
+    return;
+  }
+  cliStreamFifo.push(frame, size);
+}
+
+// Called from the CLI task, hands the contiguous spans of the fifo to the serial port,
+// only what it accepts without blocking
+void cliStreamFlush()
+{
+  uint8_t * data;
+  uint32_t len;
+  while ((len = cliStreamFifo.readSpan(data)) > 0) {
+    uint32_t written = serialWrite(data, len);
+    cliStreamFifo.skip(written);
+    if (written < len) {
+      break;
+    }
+  }
+}
+
+int cliStream(const char ** argv)
+{
+  int mask = 0;
+  if (!strcmp(argv[1], "off")) {
+    cliStreamMask = 0;
+  }
+  else if (!strcmp(argv[1], "stats")) {
+    serialPrint("%d frames, %d dropped", cliStreamSequence, cliStreamDropped);
+  }
+  else if (toInt(argv, 1, &mask) > 0 && mask > 0 && (mask & ~CLI_STREAM_ALL) == 0) {
+    cliStreamResetRequest = true;
+    cliStreamMask = mask;
+  }
+  else {
+    serialPrint("%s: Invalid argument \"%s\"", argv[0], argv[1]);
+  }
+  return 0;
+}
+
+#if defined(USE_BIN_ALLOCATOR)
+int cliAllocator(const char ** argv)
+{
+  dumpBinAllocatorStats(serialPrintf);
+  return 0;
+}
+#endif
+
+#if defined(TRACE_TIMING)
+int cliTiming(const char ** argv)
+{
+  if (!strcmp(argv[1], "clear")) {
+    clearTimingTrace();
+  }
+  else if (!strcmp(argv[1], "lost")) {
+    serialPrint("%d events lost", getTimingTraceLost());
+  }
+  else {
+    // only the events recorded since the previous dump are printed
+    dumpTimingTrace(serialPrintf);
+  }
+  return 0;
+}
+#endif
+
 int cliStackInfo(const char ** argv)
 {
   int tid = 0;
@@ -253,11 +409,18 @@ int cliDisplay(const char ** argv)
 int cliHelp(const char ** argv);
 
 const CliCommand cliCommands[] = {
+#if defined(USE_BIN_ALLOCATOR)
+  { "allocator", cliAllocator, "" },
+#endif
   { "beep", cliBeep, "[<frequency>] [<duration>]" },
   { "ls", cliLs, "<directory>" },
   { "play", cliPlay, "<filename>" },
   { "print", cliDisplay, "<address> [<size>] | <what>" },
   { "stackinfo", cliStackInfo, "<tid>" },
+  { "stream", cliStream, "<mask> | off | stats" },
+#if defined(TRACE_TIMING)
+  { "timing", cliTiming, "[clear | lost]" },
+#endif
   { "trace", cliTrace, "on | off" },
   { "volume", cliVolume, "<level>" },
   { "help", cliHelp, "[<command>]" },
@@ -323,7 +486,13 @@ void cliTask(void * pdata)
     uint8_t c;
 
     while (!cliRxFifo.pop(c)) {
-      CoTickDelay(10); // 20ms
+      if (cliStreamMask || !cliStreamFifo.isEmpty()) {
+        cliStreamFlush();
+        CoTickDelay(1); // 2ms
+      }
+      else {
+        CoTickDelay(10); // 20ms
+      }
     }
 
     if (c == 12) {
@@ -41,6 +41,15 @@
 
 extern uint8_t cliTracesEnabled;
 
+// Binary stream fields (stream command mask)
+#define CLI_STREAM_CHANNELS            0x01
+#define CLI_STREAM_STICKS              0x02
+#define CLI_STREAM_LOGICAL_SWITCHES    0x04
+#define CLI_STREAM_TELEMETRY           0x08
+#define CLI_STREAM_ALL                 0x0F
+
+extern uint8_t cliStreamMask;
+
 #ifdef __cplusplus
 #include "fifo.h"
 extern Fifo<256> cliRxFifo;
@@ -50,5 +59,6 @@ extern TaskStack<CLI_STACK_SIZE> cliStack;
 #endif
 
 void cliStart();
+void cliStreamFrame();
 
 #endif // _CLI_H_
@@ -59,6 +59,141 @@ void debugPrintf(const char * format, ...)
 }
 #endif
 
+#if defined(TRACE_TIMING)
+/*
+ * Timing events are only stored here, in a ring buffer which may be written
+ * from any task or ISR. The slot is reserved with an atomic increment, there
+ * is no lock and no formatting, the text is produced later by dumpTimingTrace()
+ * in the CLI task (lowest priority). When the buffer wraps before being dumped,
+ * the oldest events are lost and counted.
+ *
+ * Each slot is published by writing its sequence number last, so the dumper
+ * can tell a slot which is not filled yet (it stops there and resumes on the
+ * next dump) from a slot which has been overwritten while it was printed (it
+ * is skipped and counted as lost).
+ */
+static struct TimingTraceElement timingTrace[TIMING_TRACE_LEN];
+static volatile uint32_t timingTraceWrite;
+static uint32_t timingTraceRead;
+static uint32_t timingTraceLost;
+
+#if defined(SIMU)
+#include <sys/time.h>
+static inline uint16_t getTimingTraceTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (tv.tv_sec * 2000000) + (tv.tv_usec * 2);
+}
+#define timingTraceBarrier() __sync_synchronize()
+#else
+#define getTimingTraceTime() getTmr2MHz()
+#define timingTraceBarrier() __DMB()
+#endif
+
+static inline uint32_t reserveTimingTraceSlot()
+{
+#if defined(SIMU)
+  return __sync_fetch_and_add(&timingTraceWrite, 1);
+#else
+  uint32_t index;
+  do {
+    index = __LDREXW((uint32_t *)&timingTraceWrite);
+  } while (__STREXW(index + 1, (uint32_t *)&timingTraceWrite));
+  return index;
+#endif
+}
+
+void trace_timing(uint8_t event, uint32_t data)
+{
+  // both clocks are read together once the slot is taken, so that they stay
+  // consistent; an interrupt taking the next slot before the reads may still
+  // record an earlier time, the dump shows it as a negative delta
+  uint32_t index = reserveTimingTraceSlot();
+  uint16_t time = getTimingTraceTime();
+  uint16_t ticks = g_tmr10ms;
+  struct TimingTraceElement * p = &timingTrace[index & (TIMING_TRACE_LEN-1)];
+  p->seq = 0;
+  timingTraceBarrier();
+  p->time = time;
+  p->ticks = ticks;
+  p->event = event;
+  p->data = data;
+  timingTraceBarrier();
+  p->seq = index + 1;
+}
+
+void clearTimingTrace()
+{
+  timingTraceRead = timingTraceWrite;
+  timingTraceLost = 0;
+}
+
+uint32_t getTimingTraceLost()
+{
+  return timingTraceLost;
+}
+
+// copies the slot and returns true if it was completely written and not
+// overwritten during the copy
+static bool readTimingTraceSlot(uint32_t index, struct TimingTraceElement * e)
+{
+  volatile struct TimingTraceElement * p = &timingTrace[index & (TIMING_TRACE_LEN-1)];
+  uint32_t seq = p->seq;
+  timingTraceBarrier();
+  e->time = p->time;
+  e->ticks = p->ticks;
+  e->event = p->event;
+  e->data = p->data;
+  timingTraceBarrier();
+  return seq == index + 1 && p->seq == seq;
+}
+
+void dumpTimingTrace(timingTracePrintFunc print)
+{
+  bool first = true;
+  struct TimingTraceElement previous;
+
+  // the events recorded while printing are left for the next dump
+  uint32_t end = timingTraceWrite;
+  for (; (int32_t)(end - timingTraceRead) > 0; timingTraceRead++) {
+    struct TimingTraceElement e;
+    uint32_t write = timingTraceWrite;
+    if (write - timingTraceRead > TIMING_TRACE_LEN) {
+      // the writers went round the buffer since the last dump (or while printing)
+      timingTraceLost += write - timingTraceRead - TIMING_TRACE_LEN;
+      timingTraceRead = write - TIMING_TRACE_LEN;
+      if ((int32_t)(end - timingTraceRead) <= 0) {
+        break;
+      }
+    }
+    if (!readTimingTraceSlot(timingTraceRead, &e)) {
+      if (timingTraceWrite - timingTraceRead > TIMING_TRACE_LEN) {
+        // overwritten while it was copied
+        timingTraceLost++;
+        continue;
+      }
+      // reserved but not written yet, it will be printed by the next dump
+      break;
+    }
+    if (first) {
+      previous = e;
+      first = false;
+    }
+    int16_t ticks = e.ticks - previous.ticks;
+    if (ticks >= 3 || ticks <= -3) {
+      // the 2MHz timer may have wrapped, only the 10ms ticks are reliable
+      print("%05u %+6dms %3d 0x%08x\r\n", e.time, ticks * 10, e.event, e.data);
+    }
+    else {
+      int16_t delta = e.time - previous.time;
+      print("%05u %+6dus %3d 0x%08x\r\n", e.time, delta / 2, e.event, e.data);
+    }
+    previous = e;
+  }
+}
+#endif // #if defined(TRACE_TIMING)
+
 #if defined(DEBUG_TRACE_BUFFER)
 static struct TraceElement traceBuffer[TRACE_BUFFER_LEN];
 static uint8_t traceBufferPos;
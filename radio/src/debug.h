@@ -141,6 +141,43 @@ void dumpTraceBuffer();
 
 #endif // #if defined(DEBUG_TRACE_BUFFER)
 
+#if defined(TRACE_TIMING)
+
+#define TIMING_TRACE_LEN  256   // must be a power of 2
+
+enum TimingEvent {
+  timing_mixer_start = 1,
+  timing_mixer_end,
+  timing_pulses_setup_start,
+  timing_pulses_setup_end,
+
+  timing_user = 100,    // first event available for temporary instrumentation
+};
+
+struct TimingTraceElement {
+  uint32_t seq;         // slot index + 1, written last, 0 while the slot is being written
+  uint16_t time;        // 2MHz timer, wraps every 32.7ms
+  uint16_t ticks;       // 10ms ticks, used when two events are more than 30ms apart
+  uint8_t event;
+  uint8_t reserved[3];
+  uint32_t data;
+};
+
+typedef void (*timingTracePrintFunc)(const char * format, ...);
+
+void trace_timing(uint8_t event, uint32_t data);
+void dumpTimingTrace(timingTracePrintFunc print);
+void clearTimingTrace();
+uint32_t getTimingTraceLost();
+
+#define TRACE_TIMING_EVENT(event, data)  trace_timing(event, data)
+
+#else  // #if defined(TRACE_TIMING)
+
+#define TRACE_TIMING_EVENT(event, data)
+
+#endif // #if defined(TRACE_TIMING)
+
 #if defined(TRACE_SD_CARD)
   #define TRACE_SD_CARD_EVENT(condition, event, data)  TRACE_EVENT(condition, event, data)
 #else
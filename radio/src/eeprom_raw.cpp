@@ -378,6 +378,7 @@ void eeLoadModel(uint8_t id)
         telemetryItems[i].lastReceived = TELEMETRY_VALUE_OLD;   // #3595: make value visible even before the first new value is received)
       }
     }
+    invalidateCalculatedSensors();
 #endif
 
     LOAD_MODEL_CURVES();
@@ -43,7 +43,9 @@ class Fifo
   public:
     Fifo():
       widx(0),
-      ridx(0)
+      ridx(0),
+      overruns(0),
+      overrunsSeen(0)
     {
     }
 
@@ -56,7 +58,7 @@ class Fifo
     }
 
     bool pop(uint8_t & byte) {
-      if (isEmpty()) {
+      if (checkOverrun() || isEmpty()) {
         return false;
       }
       else {
@@ -75,14 +77,117 @@ class Fifo
       return (next == ridx);
     }
 
+    uint32_t size() {
+      return (N + widx - ridx) & (N-1);
+    }
+
+    uint32_t space() {
+      return N - 1 - size();
+    }
+
     void flush() {
       while (!isEmpty()) {};
     }
 
+    void clear() {
+      ridx = widx = 0;
+      overrunsSeen = overruns;
+    }
+
+    // Bulk read: returns how many bytes may be read in one go at data,
+    // the caller then releases them with skip()
+    uint32_t readSpan(uint8_t * & data) {
+      checkOverrun();
+      uint32_t r = ridx;
+      uint32_t w = widx;
+      data = &fifo[r];
+      return (w >= r ? w : N) - r;
+    }
+
+    void skip(uint32_t count) {
+      ridx = (ridx + count) & (N-1);
+    }
+
+    // Bulk write: writes as many bytes as there is space for, returns their count
+    uint32_t push(const uint8_t * buffer, uint32_t count) {
+      uint32_t result = 0;
+      while (result < count) {
+        uint32_t w = widx;
+        uint32_t r = ridx;
+        uint32_t len = (r > w ? r - 1 : (r == 0 ? N - 1 : N)) - w;
+        if (len == 0) {
+          break;
+        }
+        if (len > count - result) {
+          len = count - result;
+        }
+        memcpy(&fifo[w], buffer + result, len);
+        widx = (w + len) & (N-1);
+        result += len;
+      }
+      return result;
+    }
+
+    uint32_t pop(uint8_t * buffer, uint32_t count) {
+      uint32_t result = 0;
+      uint8_t * data;
+      uint32_t len;
+      while (result < count && (len = readSpan(data)) > 0) {
+        if (len > count - result) {
+          len = count - result;
+        }
+        memcpy(buffer + result, data, len);
+        skip(len);
+        result += len;
+      }
+      return result;
+    }
+
+    // Producer side for a circular DMA writing straight into the buffer
+    uint8_t * buffer() {
+      return fifo;
+    }
+
+    // The DMA position has to be given at least every half buffer (half /
+    // full transfer interrupts), so that the bytes written since the previous
+    // call are known. When they don't fit in the space left, the DMA went round
+    // over unread bytes.
+    void setWriteIndex(uint32_t index) {
+      index &= (N-1);
+      if (size() + ((index - widx) & (N-1)) >= N) {
+        overruns++;
+      }
+      widx = index;
+    }
+
+    // The unread bytes can't be trusted any more (DMA overrun, bytes received
+    // with an error), they will be dropped by the consumer
+    void setOverrun() {
+      overruns++;
+    }
+
+    // Consumer side: drops the unread bytes after an overrun, returns true if it did
+    bool checkOverrun() {
+      uint8_t count = overruns;
+      if (count != overrunsSeen) {
+        overrunsSeen = count;
+        ridx = widx;
+        return true;
+      }
+      return false;
+    }
+
+    // Consumer side: a change tells that bytes were dropped since the last look
+    uint8_t getOverruns() {
+      return overruns;
+    }
+
   protected:
     uint8_t fifo[N];
     volatile uint32_t widx;
     volatile uint32_t ridx;
+    volatile uint8_t overruns;  // written by the producer only
+    uint8_t overrunsSeen;
 };
 
 #endif // _FIFO_H_
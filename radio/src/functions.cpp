@@ -249,6 +249,21 @@ void playCustomFunctionFile(const CustomFunctionData *sd, uint8_t id)
 getvalue_t requiredSpeakerVolumeRawLast = 1024 + 1; //initial value must be outside normal range
 #endif
 
+#if defined(CPUARM)
+// Empty functions are not evaluated, the list of the used ones is rebuilt each time their table is modified (eeDirty)
+void compileFunctions(const CustomFunctionData * functions, CustomFunctionsContext & functionsContext)
+{
+  uint8_t count = 0;
+  for (uint8_t i=0; i<NUM_CFN; i++) {
+    if (CFN_SWITCH(&functions[i])) {
+      functionsContext.slots[count++] = i;
+    }
+  }
+  functionsContext.slotsCount = count;
+  functionsContext.slotsValid = true;
+}
+#endif
+
 #if defined(CPUARM)
 void evalFunctions(const CustomFunctionData * functions, CustomFunctionsContext & functionsContext)
 #else
@@ -283,7 +298,16 @@ void evalFunctions()
   }
 #endif
 
+#if defined(CPUARM)
+  if (!functionsContext.slotsValid) {
+    compileFunctions(functions, functionsContext);
+  }
+
+  for (uint8_t slot=0; slot<functionsContext.slotsCount; slot++) {
+    uint8_t i = functionsContext.slots[slot];
+#else
   for (uint8_t i=0; i<NUM_CFN; i++) {
+#endif
     const CustomFunctionData * cfn = &functions[i];
     int8_t swtch = CFN_SWITCH(cfn);
     if (swtch) {
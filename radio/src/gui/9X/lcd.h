@@ -279,6 +279,7 @@ uint8_t	lcdRefresh_ST7920(uint8_t full);
 #if defined(SIMU)
   extern bool lcd_refresh;
   extern display_t lcd_buf[DISPLAY_BUF_SIZE];
+  bool lcdGetDamage(int & firstRow, int & lastRow);
 #endif
 
 char *strAppend(char * dest, const char * source, int len=0);
@@ -55,6 +55,36 @@ void lcd_clear()
   memset(displayBuf, 0, DISPLAY_BUFER_SIZE);
 }
 
+#define PIXEL_GREY_MASK(y, att) (((y) & 1) ? (0xF0 - (COLOUR_MASK(att) >> 12)) : (0x0F - (COLOUR_MASK(att) >> 16)))
+
+// FORCE, ERASE and XOR are all applied to a byte as *p = (*p & and) ^ xor
+#define LCD_MASK_AND(mask, att) ((uint8_t)(((att) & (FORCE|ERASE)) ? ~(mask) : 0xFF))
+#define LCD_MASK_XOR(mask, att) ((uint8_t)((((att) & (FORCE|ERASE)) == ERASE) ? 0 : (mask)))
+
+// Applies the same mask to w consecutive bytes (one nibble or a pair of nibbles on each of w pixels),
+// the bytes are processed by aligned words of 4
+void lcdMaskSpan(uint8_t * p, coord_t w, uint8_t mask, LcdFlags att)
+{
+  uint8_t andMask = LCD_MASK_AND(mask, att);
+  uint8_t xorMask = LCD_MASK_XOR(mask, att);
+  for (; w > 0 && ((uintptr_t)p & 3); w--, p++) {
+    *p = (*p & andMask) ^ xorMask;
+  }
+  if (w >= 4) {
+    uint32_t andWord = andMask * 0x01010101;
+    uint32_t xorWord = xorMask * 0x01010101;
+    for (; w >= 4; w -= 4, p += 4) {
+      uint32_t word;
+      memcpy(&word, p, 4);
+      word = (word & andWord) ^ xorWord;
+      memcpy(p, &word, 4);
+    }
+  }
+  for (; w > 0; w--, p++) {
+    *p = (*p & andMask) ^ xorMask;
+  }
+}
+
 coord_t lcdLastPos;
 coord_t lcdNextPos;
 
@@ -485,11 +515,21 @@ void lcd_line(coord_t x1, coord_t y1, coord_t x2, coord_t y2, uint8_t pat, LcdFl
   int px = x1;
   int py = y1;
 
+  // both ends are inside the display, so is each pixel of the line
+  uint8_t evenMask = PIXEL_GREY_MASK(0, att), oddMask = PIXEL_GREY_MASK(1, att);
+  uint8_t andMask[2] = { LCD_MASK_AND(evenMask, att), LCD_MASK_AND(oddMask, att) };
+  uint8_t xorMask[2] = { LCD_MASK_XOR(evenMask, att), LCD_MASK_XOR(oddMask, att) };
+#define LINE_PIXEL(px, py) do { \
+    uint8_t * p = &displayBuf[(py)/2*LCD_W + (px)]; \
+    if (att & FILL_WHITE) lcd_mask(p, (py)&1 ? oddMask : evenMask, att); \
+    else *p = (*p & andMask[(py)&1]) ^ xorMask[(py)&1]; \
+  } while(0)
+
   if (dxabs >= dyabs) {
     /* the line is more horizontal than vertical */
     for (int i=0; i<=dxabs; i++) {
       if ((1<<(px%8)) & pat) {
-        lcd_plot(px, py, att);
+        LINE_PIXEL(px, py);
       }
       y += dyabs;
       if (y>=dxabs) {
@@ -503,7 +543,7 @@ void lcd_line(coord_t x1, coord_t y1, coord_t x2, coord_t y2, uint8_t pat, LcdFl
     /* the line is more vertical than horizontal */
     for (int i=0; i<=dyabs; i++) {
       if ((1<<(py%8)) & pat) {
-        lcd_plot(px, py, att);
+        LINE_PIXEL(px, py);
       }
       x += dxabs;
       if (x >= dyabs) {
@@ -513,6 +553,7 @@ void lcd_line(coord_t x1, coord_t y1, coord_t x2, coord_t y2, uint8_t pat, LcdFl
       py += sdy;
     }
   }
+#undef LINE_PIXEL
 }
 
 void lcd_vline(coord_t x, scoord_t y, scoord_t h)
@@ -533,6 +574,31 @@ void lcd_rect(coord_t x, coord_t y, coord_t w, coord_t h, uint8_t pat, LcdFlags
 #if !defined(BOOT)
 void drawFilledRect(coord_t x, scoord_t y, coord_t w, coord_t h, uint8_t pat, LcdFlags att)
 {
+  if (pat == SOLID && !(att & (ROUND|FILL_WHITE))) {
+    // clipped once, then the two pixel rows which share the same bytes are drawn together
+    if (w < 0) { x += w; w = -w; }
+    if (x+w > LCD_W) {
+      if (x >= LCD_W) return;
+      w = LCD_W - x;
+    }
+    if (x < 0) { w += x; x = 0; }
+    scoord_t yend = min<scoord_t>(y+h, LCD_H);
+    if (y < 0) y = 0;
+    if (w <= 0) return;
+    while (y < yend) {
+      uint8_t * p = &displayBuf[y / 2 * LCD_W + x];
+      if (!(y & 1) && y+1 < yend) {
+        lcdMaskSpan(p, w, PIXEL_GREY_MASK(0, att) | PIXEL_GREY_MASK(1, att), att);
+        y += 2;
+      }
+      else {
+        lcdMaskSpan(p, w, PIXEL_GREY_MASK(y, att), att);
+        y += 1;
+      }
+    }
+    return;
+  }
+
   for (scoord_t i=y; i<y+h; i++) {
     if ((att&ROUND) && (i==y || i==y+h-1))
       lcd_hlineStip(x+1, i, w-2, pat, att);
@@ -1026,8 +1092,6 @@ void lcd_mask(uint8_t *p, uint8_t mask, LcdFlags att)
   }
 }
 
-#define PIXEL_GREY_MASK(y, att) (((y) & 1) ? (0xF0 - (COLOUR_MASK(att) >> 12)) : (0x0F - (COLOUR_MASK(att) >> 16)))
-
 void lcd_plot(coord_t x, coord_t y, LcdFlags att)
 {
   if (lcdIsPointOutside(x, y)) return;
@@ -1045,17 +1109,44 @@ void lcd_hlineStip(coord_t x, coord_t y, coord_t w, uint8_t pat, LcdFlags att)
     w = LCD_W - x;
   }
 
+  if (x < 0) {
+    // the pattern goes on with the pixels on the left of the display
+    for (; x < 0 && w > 0; x++, w--) {
+      pat = (pat >> 1) | ((pat & 1) << 7);
+    }
+    if (w == 0) return;
+  }
+
   uint8_t *p  = &displayBuf[ y / 2 * LCD_W + x ];
   uint8_t mask = PIXEL_GREY_MASK(y, att);
-  while (w--) {
-    if (pat&1) {
-      lcd_mask(p, mask, att);
-      pat = (pat >> 1) | 0x80;
+  if (att & FILL_WHITE) {
+    while (w--) {
+      if (pat&1) {
+        lcd_mask(p, mask, att);
+        pat = (pat >> 1) | 0x80;
+      }
+      else {
+        pat = pat >> 1;
+      }
+      p++;
     }
-    else {
-      pat = pat >> 1;
+  }
+  else if (pat == SOLID) {
+    lcdMaskSpan(p, w, mask, att);
+  }
+  else {
+    uint8_t andMask = LCD_MASK_AND(mask, att);
+    uint8_t xorMask = LCD_MASK_XOR(mask, att);
+    while (w--) {
+      if (pat&1) {
+        *p = (*p & andMask) ^ xorMask;
+        pat = (pat >> 1) | 0x80;
+      }
+      else {
+        pat = pat >> 1;
+      }
+      p++;
     }
-    p++;
   }
 }
 
@@ -1067,18 +1158,39 @@ void lcd_vlineStip(coord_t x, scoord_t y, scoord_t h, uint8_t pat, LcdFlags att)
   if (y<0) { h+=y; y=0; if (h<=0) return; }
   if (y+h > LCD_H) { h = LCD_H - y; }
 
+  if (x < 0) return;
+
   if (pat==DOTTED && !(y%2)) {
     pat = ~pat;
   }
 
+  if (att & FILL_WHITE) {
+    while (h--) {
+      if (pat & 1) {
+        lcd_plot(x, y, att);
+        pat = (pat >> 1) | 0x80;
+      }
+      else {
+        pat = pat >> 1;
+      }
+      y++;
+    }
+    return;
+  }
+
+  uint8_t evenMask = PIXEL_GREY_MASK(0, att), oddMask = PIXEL_GREY_MASK(1, att);
+  uint8_t andMask[2] = { LCD_MASK_AND(evenMask, att), LCD_MASK_AND(oddMask, att) };
+  uint8_t xorMask[2] = { LCD_MASK_XOR(evenMask, att), LCD_MASK_XOR(oddMask, att) };
+  uint8_t *p = &displayBuf[ y / 2 * LCD_W + x ];
   while (h--) {
     if (pat & 1) {
-      lcd_plot(x, y, att);
+      *p = (*p & andMask[y&1]) ^ xorMask[y&1];
       pat = (pat >> 1) | 0x80;
     }
     else {
       pat = pat >> 1;
     }
+    if (y & 1) p += LCD_W;
     y++;
   }
 }
@@ -1086,10 +1198,8 @@ void lcd_vlineStip(coord_t x, scoord_t y, scoord_t h, uint8_t pat, LcdFlags att)
 void lcd_invert_line(int8_t line)
 {
   uint8_t *p  = &displayBuf[line * 4 * LCD_W];
-  for (coord_t x=0; x<LCD_W*4; x++) {
-    ASSERT_IN_DISPLAY(p);
-    *p++ ^= 0xff;
-  }
+  ASSERT_IN_DISPLAY(p + LCD_W*4 - 1);
+  lcdMaskSpan(p, LCD_W*4, 0xff, 0);
 }
 
 #if !defined(BOOT)
@@ -1100,6 +1210,22 @@ void lcd_img(coord_t x, coord_t y, const pm_uchar * img, uint8_t idx, LcdFlags a
   uint8_t hb   = (pgm_read_byte(q++)+7) / 8;
   bool    inv  = (att & INVERS) ? true : (att & BLINK ? BLINK_ON_PHASE : false);
   q += idx*w*hb;
+  if (x >= 0 && x+w <= LCD_W && y >= 0 && y+hb*8 <= LCD_H) {
+    // the image is inside the display, no check for each pixel
+    for (uint8_t yb = 0; yb < hb; yb++) {
+      for (coord_t i=0; i<w; i++) {
+        uint8_t b = pgm_read_byte(q++);
+        uint8_t val = inv ? ~b : b;
+        for (int k=0; val; k++, val>>=1) {
+          if (val & 1) {
+            coord_t py = y+yb*8+k;
+            displayBuf[py/2*LCD_W + x+i] ^= ((py & 1) ? 0xF0 : 0x0F);
+          }
+        }
+      }
+    }
+    return;
+  }
   for (uint8_t yb = 0; yb < hb; yb++) {
     for (coord_t i=0; i<w; i++) {
       uint8_t b = pgm_read_byte(q++);
@@ -1120,28 +1246,40 @@ void lcd_bmp(coord_t x, coord_t y, const uint8_t * img, coord_t offset, coord_t
   if (!width || width > w) {
     width = w;
   }
+  if (x < 0) {
+    // the columns on the left of the display are skipped
+    if (x+width <= 0) return;
+    offset -= x;
+    width += x;
+    x = 0;
+  }
   if (x+width > LCD_W) {
     if (x >= LCD_W ) return;
     width = LCD_W-x;
   }
   uint8_t rows = (*q++ + 1) / 2;
+  // the display line which receives the first pixel row, rounded down for a negative y
+  int line = (y - (y & 1)) / 2;
 
-  for (uint8_t row=0; row<rows; row++) {
+  for (uint8_t row=0; row<rows; row++, line++) {
+    if (line >= LCD_H/2) return;
     q = img + 2 + row*w + offset;
-    uint8_t *p = &displayBuf[(row + (y/2)) * LCD_W + x];
-    for (coord_t i=0; i<width; i++) {
-      if (p >= DISPLAY_END) return;
-      uint8_t b = *q++;
-      if (y & 1) {
-        *p = (*p & 0x0f) + ((b & 0x0f) << 4);
-        if ((p+LCD_W) < DISPLAY_END) {
-          *(p+LCD_W) = (*(p+LCD_W) & 0xf0) + ((b & 0xf0) >> 4);
+    if (y & 1) {
+      // each byte of the bitmap is split between two lines of the display
+      for (coord_t i=0; i<width; i++) {
+        uint8_t b = *q++;
+        if (line >= 0) {
+          uint8_t *p = &displayBuf[line * LCD_W + x + i];
+          *p = (*p & 0x0f) + ((b & 0x0f) << 4);
+        }
+        if (line+1 < LCD_H/2) {
+          uint8_t *p = &displayBuf[(line+1) * LCD_W + x + i];
+          *p = (*p & 0xf0) + ((b & 0xf0) >> 4);
         }
       }
-      else {
-        *p = b;
-      }
-      p++;
+    }
+    else if (line >= 0) {
+      memcpy(&displayBuf[line * LCD_W + x], q, width);
     }
   }
 }
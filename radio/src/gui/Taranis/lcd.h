@@ -195,6 +195,7 @@ void putsTimer(coord_t x, coord_t y, putstime_t tme, LcdFlags att, LcdFlags att2
 
 void lcd_plot(coord_t x, coord_t y, LcdFlags att=0);
 void lcd_mask(uint8_t *p, uint8_t mask, LcdFlags att=0);
+void lcdMaskSpan(uint8_t * p, coord_t w, uint8_t mask, LcdFlags att=0);
 void lcd_hline(coord_t x, coord_t y, coord_t w, LcdFlags att=0);
 void lcd_hlineStip(coord_t x, coord_t y, coord_t w, uint8_t pat, LcdFlags att=0);
 void lcd_vline(coord_t x, scoord_t y, scoord_t h);
@@ -233,6 +234,8 @@ void lcdSetContrast();
 #endif
 
 const char *bmpLoad(uint8_t *dest, const char *filename, const unsigned int width, const unsigned int height);
+const uint8_t *bmpLoadCached(const char *filename, const unsigned int width, const unsigned int height);
+void bmpCacheClear();
 const char *writeScreenshot();
 
 #if defined(BOOT)
@@ -244,6 +247,7 @@ const char *writeScreenshot();
 #if defined(SIMU)
   extern bool lcd_refresh;
   extern display_t lcd_buf[DISPLAY_BUF_SIZE];
+  bool lcdGetDamage(int & firstRow, int & lastRow);
 #endif
 
 char *strAppend(char * dest, const char * source, int len=0);
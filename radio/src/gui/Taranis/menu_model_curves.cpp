@@ -63,9 +63,18 @@ point_t getPoint(uint8_t i)
   return result;
 }
 
+uint32_t curveFnKey()
+{
+  CurveInfo & crv = g_model.curves[s_curveChan];
+  uint8_t count = 5+crv.points;
+  uint32_t key = functionKey(0, &s_curveChan, sizeof(s_curveChan));
+  key = functionKey(key, &crv, sizeof(crv));
+  return functionKey(key, curveAddress(s_curveChan), crv.type == CURVE_TYPE_CUSTOM ? 2*count-2 : count);
+}
+
 void DrawCurve(uint8_t offset=0)
 {
-  DrawFunction(curveFn, offset);
+  DrawFunction(curveFn, curveFnKey(), offset);
 
   uint8_t i = 0;
   do {
@@ -81,15 +81,69 @@ int16_t expoFn(int16_t x)
   return anas[ed->chn];
 }
 
-void DrawFunction(FnFuncP fn, uint8_t offset)
+// Everything expoFn() depends on: the lines of the same input, their switches
+// and live sources, the curves and the GVars of the current flight mode
+uint32_t expoFnKey()
+{
+  ExpoData *ed = expoAddress(s_currIdx);
+  uint32_t key = functionKey(0, &s_currIdx, sizeof(s_currIdx));
+  key = functionKey(key, &mixerCurrentFlightMode, sizeof(mixerCurrentFlightMode));
+  for (int i=0; i<MAX_EXPOS; i++) {
+    ExpoData * line = expoAddress(i);
+    if (!EXPO_VALID(line)) break;
+    if (line->chn != ed->chn) continue;
+    uint8_t active = getSwitch(line->swtch);
+    key = functionKey(key, line, sizeof(ExpoData));
+    key = functionKey(key, &active, sizeof(active));
+    if (line->srcRaw != ed->srcRaw) {
+      int16_t value = getValue(line->srcRaw);
+      key = functionKey(key, &value, sizeof(value));
+    }
+  }
+  key = functionKey(key, g_model.curves, sizeof(g_model.curves));
+  key = functionKey(key, g_model.points, sizeof(g_model.points));
+#if defined(GVARS)
+  for (int i=0; i<MAX_GVARS; i++) {
+    int16_t value = GVAR_VALUE(i, getGVarFlightPhase(mixerCurrentFlightMode, i));
+    key = functionKey(key, &value, sizeof(value));
+  }
+#endif
+  return key;
+}
+
+// FNV-1a
+uint32_t functionKey(uint32_t key, const void * data, uint32_t size)
+{
+  const uint8_t * p = (const uint8_t *)data;
+  if (key == 0) key = 2166136261u;
+  while (size--) {
+    key = (key ^ *p++) * 16777619u;
+  }
+  return key;
+}
+
+// The function is only sampled again when its key changes, the chart is drawn from the samples otherwise
+static coord_t functionSamples[2*WCHART+1];
+static FnFuncP functionSamplesFn = NULL;
+static uint32_t functionSamplesKey;
+
+void DrawFunction(FnFuncP fn, uint32_t key, uint8_t offset)
 {
   lcd_vlineStip(X0-offset, 0/*TODO Y0-WCHART*/, WCHART*2, 0xee);
   lcd_hlineStip(X0-WCHART-offset, Y0, WCHART*2, 0xee);
 
+  if (fn != functionSamplesFn || key != functionSamplesKey) {
+    for (int xv=-WCHART; xv<=WCHART; xv++) {
+      functionSamples[xv+WCHART] = (LCD_H-1) - (((uint16_t)RESX + fn(xv * (RESX/WCHART))) / 2 * (LCD_H-1) / RESX);
+    }
+    functionSamplesFn = fn;
+    functionSamplesKey = key;
+  }
+
   coord_t prev_yv = (coord_t)-1;
 
   for (int xv=-WCHART; xv<=WCHART; xv++) {
-    coord_t yv = (LCD_H-1) - (((uint16_t)RESX + fn(xv * (RESX/WCHART))) / 2 * (LCD_H-1) / RESX);
+    coord_t yv = functionSamples[xv+WCHART];
     if (prev_yv != (coord_t)-1) {
       if (abs((int8_t)yv-prev_yv) <= 1) {
         lcd_plot(X0+xv-offset-1, prev_yv, FORCE);
@@ -396,7 +450,7 @@ void menuModelExpoOne(uint8_t event)
     y += FH;
   }
 
-  DrawFunction(expoFn);
+  DrawFunction(expoFn, expoFnKey());
 
   int x512 = getValue(ed->srcRaw);
   if (ed->srcRaw >= MIXSRC_FIRST_TELEM) {
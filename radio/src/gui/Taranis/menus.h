@@ -112,6 +112,9 @@ void menuModelSelect(uint8_t event);
 void menuModelCustomFunctions(uint8_t event);
 void menuStatisticsView(uint8_t event);
 void menuStatisticsDebug(uint8_t event);
+#if defined(LUA)
+void menuStatisticsLua(uint8_t event);
+#endif
 void menuAboutView(uint8_t event);
 #if defined(DEBUG_TRACE_BUFFER)
 void menuTraceBuffer(uint8_t event);
@@ -393,6 +396,7 @@ void menuChannelsView(uint8_t event);
 #define EDIT_MODE_INIT           0 // TODO enum
 
 typedef int16_t (*FnFuncP) (int16_t x);
-void DrawFunction(FnFuncP fn, uint8_t offset=0);
+uint32_t functionKey(uint32_t key, const void * data, uint32_t size);
+void DrawFunction(FnFuncP fn, uint32_t key, uint8_t offset=0);
 
 #endif // _MENUS_H_
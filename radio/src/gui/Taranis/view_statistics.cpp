@@ -49,7 +49,11 @@ void menuStatisticsView(uint8_t event)
   switch(event)
   {
     case EVT_KEY_FIRST(KEY_UP):
+#if defined(LUA)
+      chainMenu(menuStatisticsLua);
+#else
       chainMenu(menuStatisticsDebug);
+#endif
       break;
 
     case EVT_KEY_LONG(KEY_MENU):
@@ -143,6 +147,7 @@ void menuStatisticsDebug(uint8_t event)
 #if defined(LUA)
       maxLuaInterval = 0;
       maxLuaDuration = 0;
+      luaResetStatistics();
 #endif
       maxMixerDuration  = 0;
       AUDIO_KEYPAD_UP();
@@ -155,7 +160,11 @@ void menuStatisticsDebug(uint8_t event)
 #endif
 
     case EVT_KEY_FIRST(KEY_DOWN):
+#if defined(LUA)
+      chainMenu(menuStatisticsLua);
+#else
       chainMenu(menuStatisticsView);
+#endif
       break;
     case EVT_KEY_FIRST(KEY_EXIT):
       chainMenu(menuMainView);
@@ -210,6 +219,84 @@ void menuStatisticsDebug(uint8_t event)
   lcd_status_line();
 }
 
+#if defined(LUA)
+#define MENU_LUA_COL_AVG   27*FW
+#define MENU_LUA_COL_MAX   35*FW
+
+// The average and max run durations of each permanent script, a run may span several passes.
+// PAGE shows the next scripts when they don't fit on one screen.
+void menuStatisticsLua(uint8_t event)
+{
+  TITLE("LUA SCRIPTS");
+
+  switch(event)
+  {
+    case EVT_ENTRY:
+      menuVerticalOffset = 0;
+      break;
+    case EVT_KEY_BREAK(KEY_PAGE):
+      // next page of scripts, then back to the first one
+      menuVerticalOffset += NUM_BODY_LINES;
+      if (menuVerticalOffset >= luaScriptsCount) {
+        menuVerticalOffset = 0;
+      }
+      break;
+    case EVT_KEY_FIRST(KEY_ENTER):
+      luaResetStatistics();
+      AUDIO_KEYPAD_UP();
+      break;
+    case EVT_KEY_FIRST(KEY_UP):
+      chainMenu(menuStatisticsDebug);
+      break;
+    case EVT_KEY_FIRST(KEY_DOWN):
+      chainMenu(menuStatisticsView);
+      break;
+    case EVT_KEY_FIRST(KEY_EXIT):
+      chainMenu(menuMainView);
+      break;
+  }
+
+  lcd_putsAtt(MENU_LUA_COL_AVG-5*FW, 1, "Avg ms", SMLSIZE);
+  lcd_putsAtt(MENU_LUA_COL_MAX-5*FW, 1, "Max ms", SMLSIZE);
+
+  for (int i=menuVerticalOffset; i<luaScriptsCount && i<menuVerticalOffset+NUM_BODY_LINES; i++) {
+    ScriptInternalData & sid = scriptInternalData[i];
+    coord_t y = (i-menuVerticalOffset+1)*FH;
+    if (sid.reference <= SCRIPT_MIX_LAST) {
+      uint8_t index = sid.reference - SCRIPT_MIX_FIRST;
+      putsStrIdx(0, y, "LUA", index+1);
+      lcd_putsnAtt(6*FW, y, g_model.scriptsData[index].file, sizeof(g_model.scriptsData[index].file), 0);
+    }
+    else if (sid.reference <= SCRIPT_FUNC_LAST) {
+      uint8_t index = sid.reference - SCRIPT_FUNC_FIRST;
+      putsStrIdx(0, y, "SF", index+1);
+      lcd_putsnAtt(6*FW, y, g_model.customFn[index].play.name, sizeof(g_model.customFn[index].play.name), 0);
+    }
+    else {
+      uint8_t index = sid.reference - SCRIPT_TELEMETRY_FIRST;
+      putsStrIdx(0, y, "TELE", index+1);
+      lcd_putsnAtt(6*FW, y, g_model.frsky.screens[index].script.file, sizeof(g_model.frsky.screens[index].script.file), 0);
+    }
+    switch (sid.state) {
+      case SCRIPT_SYNTAX_ERROR:
+        lcd_puts(MENU_LUA_COL_MAX-7*FW, y, "(error)");
+        break;
+      case SCRIPT_KILLED:
+        lcd_puts(MENU_LUA_COL_MAX-8*FW, y, "(killed)");
+        break;
+      default:
+        lcd_outdezAtt(MENU_LUA_COL_AVG, y, DURATION_MS_PREC2(sid.avgDuration), PREC2);
+        lcd_outdezAtt(MENU_LUA_COL_MAX, y, DURATION_MS_PREC2(sid.maxDuration), PREC2);
+        break;
+    }
+  }
+
+  if (luaScriptsCount > NUM_BODY_LINES) {
+    displayScrollbar(DEFAULT_SCROLLBAR_X, MENU_HEADER_HEIGHT, LCD_H-MENU_HEADER_HEIGHT, menuVerticalOffset, luaScriptsCount, NUM_BODY_LINES);
+  }
+}
+#endif
+
 
 #if defined(DEBUG_TRACE_BUFFER)
 #include "stamp-opentx.h"
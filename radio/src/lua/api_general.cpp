@@ -39,6 +39,7 @@
 #include "opentx.h"
 #include "stamp-opentx.h"
 #include "lua/lua_api.h"
+#include "bin_allocator.h"
 
 #if defined(PCBTARANIS) && defined(REV9E)
   #define RADIO "taranisx9e"
@@ -245,14 +246,42 @@ void luaGetValueAndPush(int src)
   }
 }
 
+/**
+  Decoded telemetry sensor labels, refreshed entry by entry
+  when the raw (zchar) label of a sensor changes
+*/
+struct LuaSensorName {
+  char label[TELEM_LABEL_LEN];
+  uint8_t len;
+  char name[TELEM_LABEL_LEN+1];
+};
+
+static LuaSensorName luaSensorNames[MAX_SENSORS];
+
+static const LuaSensorName & luaGetSensorName(int index)
+{
+  LuaSensorName & sensorName = luaSensorNames[index];
+  const char * label = g_model.telemetrySensors[index].label;
+  if (sensorName.len == 0 || memcmp(sensorName.label, label, TELEM_LABEL_LEN)) {
+    memcpy(sensorName.label, label, TELEM_LABEL_LEN);
+    // len is stored +1 so that a zeroed entry is always refreshed
+    sensorName.len = zchar2str(sensorName.name, label, TELEM_LABEL_LEN) + 1;
+  }
+  return sensorName;
+}
+
 /**
   Return field data for a given field name
 */
 bool luaFindFieldByName(const char * name, LuaField & field, unsigned int flags=0)
 {
-  // TODO better search method (binary lookup)
-  for (unsigned int n=0; n<DIM(luaSingleFields); ++n) {
-    if (!strcmp(name, luaSingleFields[n].name)) {
+  // luaSingleFields[] is sorted by name (see luaexport.py)
+  int first = 0;
+  int last = DIM(luaSingleFields) - 1;
+  while (first <= last) {
+    int n = (first + last) / 2;
+    int cmp = strcmp(name, luaSingleFields[n].name);
+    if (cmp == 0) {
       field.id = luaSingleFields[n].id;
       if (flags & FIND_FIELD_DESC) {
         strncpy(field.desc, luaSingleFields[n].desc, sizeof(field.desc)-1);
@@ -263,6 +292,12 @@ bool luaFindFieldByName(const char * name, LuaField & field, unsigned int flags=
       }
       return true;
     }
+    else if (cmp < 0) {
+      last = n - 1;
+    }
+    else {
+      first = n + 1;
+    }
   }
 
   // search in multiples
@@ -299,9 +334,9 @@ bool luaFindFieldByName(const char * name, LuaField & field, unsigned int flags=
   field.desc[0] = '\0';
   for (int i=0; i<MAX_SENSORS; i++) {
     if (isTelemetryFieldAvailable(i)) {
-      char sensorName[TELEM_LABEL_LEN+1];
-      int len = zchar2str(sensorName, g_model.telemetrySensors[i].label, TELEM_LABEL_LEN);
-      if (!strncmp(sensorName, name, len)) {
+      const LuaSensorName & sensorName = luaGetSensorName(i);
+      int len = sensorName.len - 1;
+      if (!strncmp(sensorName.name, name, len)) {
         if (name[len] == '\0') {
           field.id = MIXSRC_FIRST_TELEM + 3*i;
           field.desc[0] = '\0';
@@ -385,7 +420,8 @@ To get a telemetry value simply use it's sensor name. For example:
  * to get the minimum altitude use the source "Alt-", to get the maximum use "Alt+"
 
 @param source  can be an identifier (number) (which was obtained by the getFieldInfo())
-or a name (string) of the source.
+or a name (string) of the source. Several sources can be given, one value is then
+returned for each of them, in the same order.
 
 @retval value current source value (number). Zero is returned for:
  * non-existing sources
@@ -407,29 +443,38 @@ case the returned value is 0):
   * value (number) current cell voltage
 
 @status current Introduced in 2.0.0, changed in 2.1.0, `Cels+` and 
-`Cels-` added in 2.1.9
+`Cels-` added in 2.1.9, multiple sources added in 2.1.10
 
 @notice Getting a value by its numerical identifier is faster then by its name.
+Telemetry scripts should resolve their sources once with getFieldInfo() and then
+read all of them with a single call, i.e. `local alt, vspd = getValue(altId, vspdId)`.
 While `Cels` sensor returns current values of all cells in a table, a `Cels+` or 
 `Cels-` will return a single value - the maximum or minimum Cels value.
 */
 static int luaGetValue(lua_State *L)
 {
-  int src = 0;
-  if (lua_isnumber(L, 1)) {
-    src = luaL_checkinteger(L, 1);
+  int count = lua_gettop(L);
+  if (count < 1) {
+    count = 1; // luaL_checkstring() below raises the usual error
   }
-  else {
-    // convert from field name to its id
-    const char *name = luaL_checkstring(L, 1);
-    LuaField field;
-    bool found = luaFindFieldByName(name, field);
-    if (found) {
-      src = field.id;
+  luaL_checkstack(L, count, "too many sources");
+  for (int i=1; i<=count; i++) {
+    int src = 0;
+    if (lua_isnumber(L, i)) {
+      src = luaL_checkinteger(L, i);
     }
+    else {
+      // convert from field name to its id
+      const char *name = luaL_checkstring(L, i);
+      LuaField field;
+      bool found = luaFindFieldByName(name, field);
+      if (found) {
+        src = field.id;
+      }
+    }
+    luaGetValueAndPush(src);
   }
-  luaGetValueAndPush(src);
-  return 1;
+  return count;
 }
 
 
@@ -688,6 +733,46 @@ static int luaGetGeneralSettings(lua_State *L)
 }
 
 
+#if defined(USE_BIN_ALLOCATOR)
+template <class T> void luaPushAllocatorSlots(lua_State *L, int index, T & slots)
+{
+  lua_newtable(L);
+  lua_pushtableinteger(L, "size", slots.slot_size());
+  lua_pushtableinteger(L, "used", slots.size());
+  lua_pushtableinteger(L, "total", slots.capacity());
+  lua_pushtableinteger(L, "peak", slots.peak());
+  lua_pushtableinteger(L, "overflows", slots.overflows());
+  lua_rawseti(L, -2, index);
+}
+
+/*luadoc
+@function getAllocatorStats()
+
+Returns the usage of the Lua memory allocator slots
+
+@retval table with elements:
+ * `slots` (table) one table per slot size with `size`, `used`, `total`, `peak`
+ (highest number of slots used) and `overflows` (allocations which found all these slots
+ used and went to larger slots or to the system heap)
+ * `fallbacks` (number) allocations which had to use the system heap
+
+@status current Introduced in 2.1.10
+
+*/
+static int luaGetAllocatorStats(lua_State *L)
+{
+  lua_newtable(L);
+  lua_pushstring(L, "slots");
+  lua_newtable(L);
+  luaPushAllocatorSlots(L, 1, slots1);
+  luaPushAllocatorSlots(L, 2, slots2);
+  luaPushAllocatorSlots(L, 3, slots3);
+  lua_settable(L, -3);
+  lua_pushtableinteger(L, "fallbacks", binAllocatorFallbacks);
+  return 1;
+}
+#endif
+
 /*luadoc
 @function popupInput(title, event, input, min, max)
 
@@ -787,6 +872,9 @@ const luaL_Reg opentxLib[] = {
   { "getDateTime", luaGetDateTime },
   { "getVersion", luaGetVersion },
   { "getGeneralSettings", luaGetGeneralSettings },
+#if defined(USE_BIN_ALLOCATOR)
+  { "getAllocatorStats", luaGetAllocatorStats },
+#endif
   { "getValue", luaGetValue },
   { "getFieldInfo", luaGetFieldInfo },
   { "getFlightMode", luaGetFlightMode },
@@ -123,6 +123,44 @@ static int luaLcdDrawLine(lua_State *L)
   return 0;
 }
 
+/*luadoc
+@function lcd.drawPolyline(points [, pattern [, flags]])
+
+Draws the lines joining a series of points, in one call
+
+@param points (table) coordinates of the points {x1, y1, x2, y2, ...}
+
+@param pattern (number) pattern of the lines (default SOLID)
+
+@param flags (unsigned number) drawing flags
+
+@notice As with lcd.drawLine(), a segment with an end outside the LCD is not drawn
+
+@status current Introduced in 2.1.10
+*/
+static int luaLcdDrawPolyline(lua_State *L)
+{
+  if (!luaLcdAllowed) return 0;
+  luaL_checktype(L, 1, LUA_TTABLE);
+  int count = luaL_len(L, 1) / 2;
+  int pat = luaL_optinteger(L, 2, SOLID);
+  unsigned int flags = luaL_optunsigned(L, 3, 0);
+  int x1 = 0, y1 = 0;
+  for (int i=0; i<count; i++) {
+    lua_rawgeti(L, 1, 2*i+1);
+    lua_rawgeti(L, 1, 2*i+2);
+    int x2 = lua_tointeger(L, -2);
+    int y2 = lua_tointeger(L, -1);
+    lua_pop(L, 2);
+    if (i > 0) {
+      lcd_line(x1, y1, x2, y2, pat, flags);
+    }
+    x1 = x2;
+    y1 = y2;
+  }
+  return 0;
+}
+
 /*luadoc
 @function lcd.getLastPos()
 
@@ -321,6 +359,8 @@ Draws a bitmap at (x,y)
 
 @param name (string) full path to the bitmap on SD card (i.e. “/BMP/test.bmp”)
 
+@notice The bitmap is clipped on each side of the LCD (starting from OpenTX 2.1.10)
+
 @status current Introduced in 2.0.0
 */
 static int luaLcdDrawPixmap(lua_State *L)
@@ -329,9 +369,8 @@ static int luaLcdDrawPixmap(lua_State *L)
   int x = luaL_checkinteger(L, 1);
   int y = luaL_checkinteger(L, 2);
   const char * filename = luaL_checkstring(L, 3);
-  uint8_t bitmap[BITMAP_BUFFER_SIZE(LCD_W/2, LCD_H)]; // width max is LCD_W/2 pixels for saving stack and avoid a malloc here
-  const pm_char * error = bmpLoad(bitmap, filename, LCD_W/2, LCD_H);
-  if (!error) {
+  const uint8_t * bitmap = bmpLoadCached(filename, LCD_W/2, LCD_H); // width max is LCD_W/2 pixels
+  if (bitmap) {
     lcd_bmp(x, y, bitmap);
   }
   return 0;
@@ -428,6 +467,115 @@ static int luaLcdDrawGauge(lua_State *L)
   return 0;
 }
 
+// Returns the height in pixels (0 to h) of value v on a scale from vmin to vmax
+static int luaLcdScale(lua_Number v, lua_Number vmin, lua_Number vmax, int h)
+{
+  if (vmax <= vmin) return 0;
+  int result = (v - vmin) * h / (vmax - vmin) + 0.5;
+  return limit(0, result, h);
+}
+
+/*luadoc
+@function lcd.drawBars(x, y, w, h, values, min, max [, flags])
+
+Draws a series of vertical bars, in one call
+
+@param x,y (positive numbers) top left corner of the area
+
+@param w (number) width of the area, shared by the bars
+
+@param h (number) height of the area
+
+@param values (table) values of the bars, from left to right
+
+@param min,max (numbers) values drawn as an empty and a full bar
+
+@param flags (unsigned number) drawing flags
+
+@notice The bars are separated by a 1 pixel gap when they are at least 3 pixels wide
+
+@status current Introduced in 2.1.10
+*/
+static int luaLcdDrawBars(lua_State *L)
+{
+  if (!luaLcdAllowed) return 0;
+  int x = luaL_checkinteger(L, 1);
+  int y = luaL_checkinteger(L, 2);
+  int w = luaL_checkinteger(L, 3);
+  int h = luaL_checkinteger(L, 4);
+  luaL_checktype(L, 5, LUA_TTABLE);
+  int count = luaL_len(L, 5);
+  lua_Number vmin = luaL_checknumber(L, 6);
+  lua_Number vmax = luaL_checknumber(L, 7);
+  unsigned int flags = luaL_optunsigned(L, 8, 0);
+  if (count <= 0 || w < count) return 0;
+  int barWidth = w / count;
+  int gap = (barWidth >= 3 ? 1 : 0);
+  for (int i=0; i<count; i++) {
+    lua_rawgeti(L, 5, i+1);
+    int len = luaLcdScale(lua_tonumber(L, -1), vmin, vmax, h);
+    lua_pop(L, 1);
+    if (len > 0) {
+      drawFilledRect(x+i*barWidth, y+h-len, barWidth-gap, len, SOLID, flags);
+    }
+  }
+  return 0;
+}
+
+/*luadoc
+@function lcd.drawHistory(x, y, w, h, values, first, min, max [, flags])
+
+Draws the curve of the values of a ring buffer, in one call
+
+@param x,y (positive numbers) top left corner of the area
+
+@param w (number) width of the area, the values are spread over it
+
+@param h (number) height of the area
+
+@param values (table) the ring buffer
+
+@param first (number) index of the oldest value in the ring buffer, drawn on the left
+
+@param min,max (numbers) values drawn at the bottom and at the top of the area
+
+@param flags (unsigned number) drawing flags
+
+@notice The whole area must be inside the LCD, otherwise nothing is drawn
+
+@status current Introduced in 2.1.10
+*/
+static int luaLcdDrawHistory(lua_State *L)
+{
+  if (!luaLcdAllowed) return 0;
+  int x = luaL_checkinteger(L, 1);
+  int y = luaL_checkinteger(L, 2);
+  int w = luaL_checkinteger(L, 3);
+  int h = luaL_checkinteger(L, 4);
+  luaL_checktype(L, 5, LUA_TTABLE);
+  int count = luaL_len(L, 5);
+  int first = luaL_checkinteger(L, 6) - 1;
+  lua_Number vmin = luaL_checknumber(L, 7);
+  lua_Number vmax = luaL_checknumber(L, 8);
+  unsigned int flags = luaL_optunsigned(L, 9, 0);
+  if (count <= 0 || w <= 0 || h <= 0 || x < 0 || y < 0 || x+w > LCD_W || y+h > LCD_H) return 0;
+  if (first < 0 || first >= count) first = 0;
+  int x1 = x, y1 = 0;
+  for (int i=0; i<count; i++) {
+    lua_rawgeti(L, 5, (first+i) % count + 1);
+    int x2 = (count > 1 ? x + i*(w-1)/(count-1) : x);
+    int y2 = y + h - 1 - luaLcdScale(lua_tonumber(L, -1), vmin, vmax, h-1);
+    lua_pop(L, 1);
+    if (count == 1)
+      lcd_plot(x2, y2, flags);
+    else if (i > 0)
+      lcd_line(x1, y1, x2, y2, SOLID, flags);
+    x1 = x2;
+    y1 = y2;
+  }
+  return 0;
+}
+
 /*luadoc
 @function lcd.drawScreenTitle(title, page, pages)
 
@@ -532,9 +680,12 @@ const luaL_Reg lcdLib[] = {
   { "getLastPos", luaLcdGetLastPos },
   { "drawPoint", luaLcdDrawPoint },
   { "drawLine", luaLcdDrawLine },
+  { "drawPolyline", luaLcdDrawPolyline },
   { "drawRectangle", luaLcdDrawRectangle },
   { "drawFilledRectangle", luaLcdDrawFilledRectangle },
   { "drawGauge", luaLcdDrawGauge },
+  { "drawBars", luaLcdDrawBars },
+  { "drawHistory", luaLcdDrawHistory },
   { "drawText", luaLcdDrawText },
   { "drawTimer", luaLcdDrawTimer },
   { "drawNumber", luaLcdDrawNumber },
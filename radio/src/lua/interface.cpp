@@ -45,9 +45,11 @@
   #include <lstate.h>
 #endif
 
-#define PERMANENT_SCRIPTS_MAX_INSTRUCTIONS (10000/100)
-#define MANUAL_SCRIPTS_MAX_INSTRUCTIONS    (20000/100)
-#define SET_LUA_INSTRUCTIONS_COUNT(x)      (instructionsPercent=0, lua_sethook(L, hook, LUA_MASKCOUNT, x))
+#define PERMANENT_SCRIPTS_MAX_DURATION     (5*2000)  // 5ms slice, then the script is suspended until the next pass
+#define MANUAL_SCRIPTS_MAX_DURATION        (10*2000) // 10ms, then the script is killed
+#define PERMANENT_SCRIPTS_MAX_SLICES       100       // a run which is not finished after 100 passes is killed
+#define LUA_HOOK_INSTRUCTIONS              1000      // the time is checked every 1000 instructions
+#define SET_LUA_DURATION(L, x)             (luaStartDuration(x), lua_sethook(L, hook, LUA_MASKCOUNT, LUA_HOOK_INSTRUCTIONS))
 #define LUA_WARNING_INFO_LEN 64
 
 lua_State *L = NULL;
@@ -59,7 +61,15 @@ ScriptInternalData standaloneScript = { SCRIPT_NOFILE, 0 };
 uint16_t maxLuaInterval = 0;
 uint16_t maxLuaDuration = 0;
 bool luaLcdAllowed;
-static int instructionsPercent = 0;
+#if !defined(SIMU)
+static uint16_t luaTimer;
+static tmr10ms_t luaTimer10ms;
+static uint32_t luaTimerPreemption;
+#endif
+static uint32_t luaDuration;    // 2MHz ticks used by the current run in this pass
+static uint32_t luaMaxDuration;
+static bool luaScriptKilled;
+static lua_State * luaSuspendableThread; // the coroutine of the current run, NULL when it can't be suspended
 char lua_warning_info[LUA_WARNING_INFO_LEN+1];
 struct our_longjmp * global_lj = 0;
 
@@ -74,13 +84,72 @@ static int custom_lua_atpanic(lua_State *lua)
   return 0;
 }
 
+static void luaStartDuration(uint32_t maxDuration)
+{
+  luaDuration = 0;
+  luaMaxDuration = maxDuration;
+  luaScriptKilled = false;
+#if !defined(SIMU)
+  __disable_irq();
+  luaTimer = getTmr2MHz();
+  luaTimer10ms = get_tmr10ms();
+  luaTimerPreemption = menusTaskPreemption;
+  __enable_irq();
+#endif
+}
+
+// The script is only charged for the time it ran, not for the time the
+// mixer and audio tasks preempted the menus task
+static void luaUpdateDuration()
+{
+#if !defined(SIMU)
+  __disable_irq();
+  uint32_t elapsed = getDurationTmr2MHz(luaTimer, luaTimer10ms);
+  uint32_t preemption = menusTaskPreemption - luaTimerPreemption;
+  luaTimer += elapsed;
+  luaTimer10ms = get_tmr10ms();
+  luaTimerPreemption += preemption;
+  __enable_irq();
+  if (elapsed > preemption) {
+    luaDuration += elapsed - preemption;
+  }
+#endif
+}
+
+// A hook can't yield when a C function is between it and the coroutine entry
+// (pcall(), a metamethod or a sort() comparator called from C...)
+static bool luaIsYieldable(lua_State * L)
+{
+  lua_Debug ar;
+  for (int level=0; lua_getstack(L, level, &ar); level++) {
+    lua_getinfo(L, "S", &ar);
+    if (ar.what[0] == 'C') {
+      return false;
+    }
+  }
+  return true;
+}
+
 void hook(lua_State* L, lua_Debug *ar)
 {
-  instructionsPercent++;
-  if (instructionsPercent > 100) {
+#if defined(SIMU)
+  // the simulated 2MHz timer doesn't run, one instruction is counted as one tick
+  luaDuration += LUA_HOOK_INSTRUCTIONS;
+#else
+  luaUpdateDuration();
+#endif
+  if (!luaScriptKilled && luaDuration > luaMaxDuration) {
+    if (L == luaSuspendableThread && luaIsYieldable(L)) {
+      // the script runs in its coroutine, it will be resumed on the next pass
+      lua_yield(L, 0);
+      return;
+    }
     // From now on, as soon as a line is executed, error
     // keep erroring until you're script reaches the top
+    luaScriptKilled = true;
     lua_sethook(L, hook, LUA_MASKLINE, 0);
+  }
+  if (luaScriptKilled) {
     luaL_error(L, "");
   }
 }
@@ -186,6 +255,7 @@ void luaRegisterAll()
 void luaInit()
 {
   luaClose();
+  bmpCacheClear();
   if (luaState != INTERPRETER_PANIC) {
 #if defined(USE_BIN_ALLOCATOR)
     L = lua_newstate(bin_l_alloc, NULL);   //we use our own allocator!
@@ -217,6 +287,11 @@ void luaInit()
 void luaFree(ScriptInternalData & sid)
 {
   PROTECT_LUA() {
+    if (sid.thread) {
+      luaL_unref(L, LUA_REGISTRYINDEX, sid.threadRef);
+      sid.thread = NULL;
+      sid.slices = 0;
+    }
     if (sid.run) {
       luaL_unref(L, LUA_REGISTRYINDEX, sid.run);
       sid.run = 0;
@@ -275,7 +350,6 @@ int luaLoad(const char *filename, ScriptInternalData & sid, ScriptInputsOutputs
 {
   int init = 0;
 
-  sid.instructions = 0;
   sid.state = SCRIPT_OK;
 
 #if 0
@@ -291,7 +365,7 @@ int luaLoad(const char *filename, ScriptInternalData & sid, ScriptInputsOutputs
   luaCompileAndSave(filename);
 #endif
 
-  SET_LUA_INSTRUCTIONS_COUNT(MANUAL_SCRIPTS_MAX_INSTRUCTIONS);
+  SET_LUA_DURATION(L, MANUAL_SCRIPTS_MAX_DURATION);
 
   PROTECT_LUA() {
     if (luaL_loadfile(L, filename) == 0 &&
@@ -549,12 +623,12 @@ void luaDoOneRunStandalone(uint8_t evt)
   static uint8_t luaDisplayStatistics = false;
 
   if (standaloneScript.state == SCRIPT_OK && standaloneScript.run) {
-    SET_LUA_INSTRUCTIONS_COUNT(MANUAL_SCRIPTS_MAX_INSTRUCTIONS);
+    SET_LUA_DURATION(L, MANUAL_SCRIPTS_MAX_DURATION);
     lua_rawgeti(L, LUA_REGISTRYINDEX, standaloneScript.run);
     lua_pushinteger(L, evt);
     if (lua_pcall(L, 1, 1, 0) == 0) {
       if (!lua_isnumber(L, -1)) {
-        if (instructionsPercent > 100) {
+        if (luaScriptKilled) {
           TRACE("Script killed");
           standaloneScript.state = SCRIPT_KILLED;
           luaState = INTERPRETER_RELOAD_PERMANENT_SCRIPTS;
@@ -592,7 +666,7 @@ void luaDoOneRunStandalone(uint8_t evt)
     }
     else {
       TRACE("Script error: %s", lua_tostring(L, -1));
-      standaloneScript.state = (instructionsPercent > 100 ? SCRIPT_KILLED : SCRIPT_SYNTAX_ERROR);
+      standaloneScript.state = (luaScriptKilled ? SCRIPT_KILLED : SCRIPT_SYNTAX_ERROR);
       luaState = INTERPRETER_RELOAD_PERMANENT_SCRIPTS;
     }
 
@@ -614,13 +688,24 @@ void luaDoOneRunStandalone(uint8_t evt)
   }
 }
   
+static void luaUpdateStatistics(ScriptInternalData & sid, uint32_t duration)
+{
+  if (duration > sid.maxDuration) {
+    sid.maxDuration = duration;
+  }
+  sid.avgDuration = (sid.avgDuration == 0 ? duration : (7*sid.avgDuration + duration) / 8);
+}
+
+// The foreground telemetry scripts run directly, they are killed when over their time slice,
+// otherwise a partly drawn screen would be displayed. The other scripts run in a coroutine
+// which is suspended when over its time slice, and resumed on the next pass.
 bool luaDoOneRunPermanentScript(uint8_t evt, int i, uint32_t scriptType)
 {
   ScriptInternalData & sid = scriptInternalData[i];
   if (sid.state != SCRIPT_OK) return false;
 
-  SET_LUA_INSTRUCTIONS_COUNT(PERMANENT_SCRIPTS_MAX_INSTRUCTIONS);
   int inputsCount = 0;
+  bool foreground = false;
 #if defined(SIMU) || defined(DEBUG)
   const char *filename;
 #endif
@@ -632,25 +717,29 @@ bool luaDoOneRunPermanentScript(uint8_t evt, int i, uint32_t scriptType)
 #endif
     ScriptData & sd = g_model.scriptsData[sid.reference-SCRIPT_MIX_FIRST];
     sio = &scriptInputsOutputs[sid.reference-SCRIPT_MIX_FIRST];
-    inputsCount = sio->inputsCount;
 #if defined(SIMU) || defined(DEBUG)
     filename = sd.file;
 #endif
-    lua_rawgeti(L, LUA_REGISTRYINDEX, sid.run);
-    for (int j=0; j<sio->inputsCount; j++) {
-      if (sio->inputs[j].type == 1)
-        luaGetValueAndPush((uint8_t)sd.inputs[j]);
-      else
-        lua_pushinteger(L, sd.inputs[j] + sio->inputs[j].def);
+    if (!sid.slices) {
+      inputsCount = sio->inputsCount;
+      lua_rawgeti(L, LUA_REGISTRYINDEX, sid.run);
+      for (int j=0; j<sio->inputsCount; j++) {
+        if (sio->inputs[j].type == 1)
+          luaGetValueAndPush((uint8_t)sd.inputs[j]);
+        else
+          lua_pushinteger(L, sd.inputs[j] + sio->inputs[j].def);
+      }
     }
   }
   else if ((scriptType & RUN_FUNC_SCRIPT) && (sid.reference >= SCRIPT_FUNC_FIRST && sid.reference <= SCRIPT_FUNC_LAST)) {
     CustomFunctionData & fn = g_model.customFn[sid.reference-SCRIPT_FUNC_FIRST];
-    if (!getSwitch(fn.swtch)) return false;
 #if defined(SIMU) || defined(DEBUG)
     filename = fn.play.name;
 #endif
-    lua_rawgeti(L, LUA_REGISTRYINDEX, sid.run);
+    if (!sid.slices) {
+      if (!getSwitch(fn.swtch)) return false;
+      lua_rawgeti(L, LUA_REGISTRYINDEX, sid.run);
+    }
   }
   else {
 #if defined(SIMU) || defined(DEBUG)
@@ -662,35 +751,77 @@ bool luaDoOneRunPermanentScript(uint8_t evt, int i, uint32_t scriptType)
       lua_rawgeti(L, LUA_REGISTRYINDEX, sid.run);
       lua_pushinteger(L, evt);
       inputsCount = 1;
+      foreground = true;
     }
     else if ((scriptType & RUN_TELEM_BG_SCRIPT) && (sid.background)) {
-      lua_rawgeti(L, LUA_REGISTRYINDEX, sid.background);
+      if (!sid.slices) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, sid.background);
+      }
     }
     else {
       return false;
     }
   }
 
-  if (lua_pcall(L, inputsCount, sio ? sio->outputsCount : 0, 0) == 0) {
+  lua_State * thread = L;
+  int result;
+  if (foreground) {
+    SET_LUA_DURATION(L, PERMANENT_SCRIPTS_MAX_DURATION);
+    result = lua_pcall(L, inputsCount, 0, 0);
+  }
+  else {
+    if (!sid.thread) {
+      sid.thread = lua_newthread(L);
+      sid.threadRef = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+    thread = sid.thread;
+    if (!sid.slices) {
+      lua_xmove(L, thread, inputsCount+1);
+    }
+    SET_LUA_DURATION(thread, PERMANENT_SCRIPTS_MAX_DURATION);
+    luaSuspendableThread = thread;
+    result = lua_resume(thread, L, inputsCount);
+    luaSuspendableThread = NULL;
+  }
+  luaUpdateDuration();
+
+  if (result == LUA_YIELD) {
+    sid.runDuration += luaDuration;
+    if (++sid.slices >= PERMANENT_SCRIPTS_MAX_SLICES) {
+      TRACE("Script %8s killed", filename);
+      sid.state = SCRIPT_KILLED;
+    }
+  }
+  else if (result == LUA_OK && !luaScriptKilled) {
     if (sio) {
+      lua_settop(thread, sio->outputsCount);
       for (int j=sio->outputsCount-1; j>=0; j--) {
-        if (!lua_isnumber(L, -1)) {
-          sid.state = (instructionsPercent > 100 ? SCRIPT_KILLED : SCRIPT_SYNTAX_ERROR);
+        if (!lua_isnumber(thread, -1)) {
+          sid.state = SCRIPT_SYNTAX_ERROR;
           TRACE("Script %8s disabled", filename);
           break;
         }
-        sio->outputs[j].value = lua_tointeger(L, -1);
-        lua_pop(L, 1);
+        sio->outputs[j].value = lua_tointeger(thread, -1);
+        lua_pop(thread, 1);
       }
     }
+    if (foreground) {
+      luaUpdateStatistics(sid, luaDuration);
+    }
+    else {
+      lua_settop(thread, 0);
+      luaUpdateStatistics(sid, sid.runDuration + luaDuration);
+      sid.runDuration = 0;
+      sid.slices = 0;
+    }
   }
   else {
-    if (instructionsPercent > 100) {
+    if (luaScriptKilled) {
       TRACE("Script %8s killed", filename);
       sid.state = SCRIPT_KILLED;
     }
     else {
-      TRACE("Script %8s error: %s", filename, lua_tostring(L, -1));
+      TRACE("Script %8s error: %s", filename, lua_tostring(thread, -1));
       sid.state = SCRIPT_SYNTAX_ERROR;
     }
   }
@@ -698,14 +829,22 @@ bool luaDoOneRunPermanentScript(uint8_t evt, int i, uint32_t scriptType)
   if (sid.state != SCRIPT_OK) {
     luaFree(sid);
   }
-  else {
-    if (instructionsPercent > sid.instructions) {
-      sid.instructions = instructionsPercent;
-    }
-  }
   return true;
 }
 
+uint16_t luaGetCpuUsed(int idx)
+{
+  return scriptInternalData[idx].maxDuration * 100 / PERMANENT_SCRIPTS_MAX_DURATION;
+}
+
+void luaResetStatistics()
+{
+  for (int i=0; i<luaScriptsCount; i++) {
+    scriptInternalData[i].avgDuration = 0;
+    scriptInternalData[i].maxDuration = 0;
+  }
+}
+
 void luaDoGc()
 {
   if (L) {
@@ -101,7 +101,12 @@ extern "C" {
     uint8_t state;
     int run;
     int background;
-    uint8_t instructions;
+    lua_State * thread;     // coroutine running run() / background(), suspended when over its time slice
+    int threadRef;
+    uint8_t slices;         // passes used by the suspended run, 0 when no run is suspended
+    uint32_t runDuration;   // 2MHz ticks used by the suspended run
+    uint32_t avgDuration;
+    uint32_t maxDuration;
   };
   struct ScriptInputsOutputs {
     uint8_t inputsCount;
@@ -123,7 +128,8 @@ extern "C" {
   void luaError(uint8_t error, bool acknowledge=true);
   int luaGetMemUsed();
   void luaGetValueAndPush(int src);
-  #define luaGetCpuUsed(idx) scriptInternalData[idx].instructions
+  uint16_t luaGetCpuUsed(int idx);
+  void luaResetStatistics();
   uint8_t isTelemetryScriptAvailable(uint8_t index);
   #define LUA_LOAD_MODEL_SCRIPTS()   luaState |= INTERPRETER_RELOAD_PERMANENT_SCRIPTS
   #define LUA_LOAD_MODEL_SCRIPT(idx) luaState |= INTERPRETER_RELOAD_PERMANENT_SCRIPTS
@@ -71,6 +71,12 @@ void handleUsbConnection()
   if (usbStarted && !usbPlugged()) {
     usbStarted = false;
   }
+
+#if defined(USB_MASS_STORAGE)
+  if (usbStarted) {
+    sdCloseIdleStream();
+  }
+#endif
   
 #if defined(USB_JOYSTICK)
   if (usbStarted ) {
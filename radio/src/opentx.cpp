@@ -64,7 +64,9 @@ void loadModelBitmap(char *name, uint8_t *bitmap)
     char lfn[] = BITMAPS_PATH "/xxxxxxxxxx.bmp";
     strncpy(lfn+sizeof(BITMAPS_PATH), name, len);
     strcpy(lfn+sizeof(BITMAPS_PATH)+len, BITMAPS_EXT);
-    if (bmpLoad(bitmap, lfn, MODEL_BITMAP_WIDTH, MODEL_BITMAP_HEIGHT) == 0) {
+    const uint8_t * cached = bmpLoadCached(lfn, MODEL_BITMAP_WIDTH, MODEL_BITMAP_HEIGHT);
+    if (cached) {
+      memcpy(bitmap, cached, BITMAP_BUFFER_SIZE(cached[0], cached[1]));
       return;
     }
   }
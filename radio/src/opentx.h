@@ -545,12 +545,24 @@ typedef struct {
   MASK_FUNC_TYPE activeFunctions;
   MASK_CFN_TYPE  activeSwitches;
   tmr10ms_t lastFunctionTime[NUM_CFN];
+#if defined(CPUARM)
+  uint8_t slots[NUM_CFN];   // the functions which have a switch, in table order
+  uint8_t slotsCount;
+  bool slotsValid;
+#endif
 
   inline bool isFunctionActive(uint8_t func)
   {
     return activeFunctions & ((MASK_FUNC_TYPE)1 << func);
   }
 
+#if defined(CPUARM)
+  inline void invalidateSlots()
+  {
+    slotsValid = false;
+  }
+#endif
+
   void reset()
   {
     memclear(this, sizeof(*this));
@@ -920,6 +932,11 @@ extern uint8_t unexpectedShutdown;
 
 extern uint16_t maxMixerDuration;
 
+#if defined(CPUARM)
+// 2MHz ticks used by the tasks which preempt the menus task (mixer, audio)
+extern volatile uint32_t menusTaskPreemption;
+#endif
+
 #if !defined(CPUARM)
 extern uint8_t g_tmr1Latency_max;
 extern uint8_t g_tmr1Latency_min;
@@ -958,6 +975,16 @@ extern uint16_t lastMixerDuration;
   uint16_t getTmr16KHz();
 #endif
 
+#if defined(CPUARM)
+  // The 2MHz ticks since (start, start10ms): the 10ms timer gives the duration
+  // within one period, the 16 bits 2MHz timer the exact one around it
+  static inline uint32_t getDurationTmr2MHz(uint16_t start, tmr10ms_t start10ms)
+  {
+    uint32_t coarse = (get_tmr10ms() - start10ms) * 20000;
+    return coarse + (int16_t)(uint16_t)(getTmr2MHz() - start - coarse);
+  }
+#endif
+
 #if !defined(CPUARM)
   uint16_t stackAvailable();
 #endif
@@ -152,6 +152,7 @@ void setupPulses(unsigned int port)
 
     switch (required_protocol) { // Start new protocol hardware here
       case PROTO_PXX:
+        resetPulsesPXX(port);
         init_pxx(port);
         break;
 #if defined(DSM2)
@@ -111,6 +111,7 @@ extern TrainerPulsesData trainerPulsesData;
 void setupPulses(unsigned int port);
 void setupPulsesDSM2(unsigned int port);
 void setupPulsesPXX(unsigned int port);
+void resetPulsesPXX(unsigned int port);
 void setupPulsesPPM(unsigned int port);
 
 void createCrossfireFrame(uint8_t * frame, int16_t * pulses);
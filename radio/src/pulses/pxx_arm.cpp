@@ -81,17 +81,36 @@ void crc(uint8_t data, unsigned int port)
   modulePulsesData[port].pxx.pcmCrc = (modulePulsesData[port].pxx.pcmCrc<<8) ^ (CRCTable[((modulePulsesData[port].pxx.pcmCrc>>8)^data) & 0xFF]);
 }
 
+// Bit stuffing (a 0 after five consecutive 1s) done one nibble at a time.
+// Indexed by the count of consecutive 1s already sent and the nibble, each entry holds the bits to send
+// MSB first (bits 0-4), how many of them (bits 5-7) and the new count of consecutive 1s (bits 8-10)
+const uint16_t pxxStuffingTable[5][16] =
+{
+  { 0x080, 0x181, 0x082, 0x283, 0x084, 0x185, 0x086, 0x387, 0x088, 0x189, 0x08a, 0x28b, 0x08c, 0x18d, 0x08e, 0x48f },
+  { 0x080, 0x181, 0x082, 0x283, 0x084, 0x185, 0x086, 0x387, 0x088, 0x189, 0x08a, 0x28b, 0x08c, 0x18d, 0x08e, 0x0be },
+  { 0x080, 0x181, 0x082, 0x283, 0x084, 0x185, 0x086, 0x387, 0x088, 0x189, 0x08a, 0x28b, 0x08c, 0x18d, 0x0bc, 0x1bd },
+  { 0x080, 0x181, 0x082, 0x283, 0x084, 0x185, 0x086, 0x387, 0x088, 0x189, 0x08a, 0x28b, 0x0b8, 0x1b9, 0x0ba, 0x2bb },
+  { 0x080, 0x181, 0x082, 0x283, 0x084, 0x185, 0x086, 0x387, 0x0b0, 0x1b1, 0x0b2, 0x2b3, 0x0b4, 0x1b5, 0x0b6, 0x3b7 }
+};
+
 #if defined(PCBTARANIS)
 
-void putPcmPart(uint8_t value, unsigned int port)
+// Sends the count lowest bits, MSB first, each one as a 1 during 9us then a 0 during 7us (0) or 15us (1)
+void putPcmBits(uint8_t bits, uint8_t count, unsigned int port)
 {
-  modulePulsesData[port].pxx.pcmValue += 18 ;                                        // Output 1 for this time
-  *modulePulsesData[port].pxx.ptr++ = modulePulsesData[port].pxx.pcmValue ;
-  modulePulsesData[port].pxx.pcmValue += 14 ;
-  if (value) {
-    modulePulsesData[port].pxx.pcmValue += 16 ;
+  PxxPulsesData & pxx = modulePulsesData[port].pxx;
+  uint16_t * ptr = pxx.ptr;
+  uint16_t value = pxx.pcmValue;
+
+  while (count--) {
+    value += 18;                                         // Output 1 for this time
+    *ptr++ = value;
+    value += (bits & (1 << count)) ? 30 : 14;
+    *ptr++ = value;                                      // Output 0 for this time
   }
-  *modulePulsesData[port].pxx.ptr++ = modulePulsesData[port].pxx.pcmValue ;  // Output 0 for this time
+
+  pxx.ptr = ptr;
+  pxx.pcmValue = value;
 }
 
 void putPcmFlush(unsigned int port)
@@ -114,13 +133,15 @@ void putPcmSerialBit(uint8_t bit, unsigned int port)
 }
 
 // 8uS/bit 01 = 0, 001 = 1
-void putPcmPart(uint8_t value, unsigned int port)
+void putPcmBits(uint8_t bits, uint8_t count, unsigned int port)
 {
-  putPcmSerialBit(0, port);
-  if (value) {
+  while (count--) {
     putPcmSerialBit(0, port);
+    if (bits & (1 << count)) {
+      putPcmSerialBit(0, port);
+    }
+    putPcmSerialBit(1, port);
   }
-  putPcmSerialBit(1, port);
 }
 
 void putPcmFlush(unsigned int port)
@@ -132,65 +153,100 @@ void putPcmFlush(unsigned int port)
 
 #endif
 
-void putPcmBit(uint8_t bit, unsigned int port)
+void putPcmNibble(uint8_t nibble, unsigned int port)
 {
-  if (bit) {
-    modulePulsesData[port].pxx.pcmOnesCount += 1;
-    putPcmPart(1, port);
-  }
-  else {
-    modulePulsesData[port].pxx.pcmOnesCount = 0;
-    putPcmPart(0, port);
-  }
-  if (modulePulsesData[port].pxx.pcmOnesCount >= 5) {
-    putPcmBit(0, port);                                // Stuff a 0 bit in
-  }
+  uint16_t stuffing = pxxStuffingTable[modulePulsesData[port].pxx.pcmOnesCount][nibble];
+  putPcmBits(stuffing & 0x1F, (stuffing >> 5) & 0x07, port);
+  modulePulsesData[port].pxx.pcmOnesCount = stuffing >> 8;
 }
 
 void putPcmByte(uint8_t byte, unsigned int port)
 {
   crc(byte, port);
-
-  for (uint8_t i=0; i<8; i++) {
-    putPcmBit(byte & 0x80, port);
-    byte <<= 1;
-  }
+  putPcmNibble(byte >> 4, port);
+  putPcmNibble(byte & 0x0F, port);
 }
 
 void putPcmHead(unsigned int port)
 {
   // send 7E, do not CRC
   // 01111110
-  putPcmPart(0, port);
-  putPcmPart(1, port);
-  putPcmPart(1, port);
-  putPcmPart(1, port);
-  putPcmPart(1, port);
-  putPcmPart(1, port);
-  putPcmPart(1, port);
-  putPcmPart(0, port);
+  putPcmBits(0x7E, 8, port);
 }
 
-void setupPulsesPXX(unsigned int port)
+// The preamble, the sync and the rx number only change with the model. They stay at the start of the pulses
+// buffer from one frame to the next, only the encoder state after them is restored
+struct PxxFramePrefix {
+  bool valid;
+  uint8_t modelId;
+  uint8_t length;
+  uint16_t pcmValue;
+  uint16_t pcmCrc;
+  uint8_t pcmOnesCount;
+#if !defined(PCBTARANIS)
+  uint16_t serialByte;
+  uint16_t serialBitCount;
+#endif
+};
+
+PxxFramePrefix pxxFramePrefix[NUM_MODULES];
+
+// Called when the port protocol changes, the pulses buffer is shared with the other protocols
+void resetPulsesPXX(unsigned int port)
 {
-  uint16_t chan=0, chan_low=0;
+  pxxFramePrefix[port].valid = false;
+}
+
+void putPcmPrefix(unsigned int port)
+{
+  PxxPulsesData & pxx = modulePulsesData[port].pxx;
+  PxxFramePrefix & prefix = pxxFramePrefix[port];
+  uint8_t modelId = g_model.header.modelId[port];
+
+  if (prefix.valid && prefix.modelId == modelId) {
+    pxx.ptr = pxx.pulses + prefix.length;
+    pxx.pcmValue = prefix.pcmValue;
+    pxx.pcmCrc = prefix.pcmCrc;
+    pxx.pcmOnesCount = prefix.pcmOnesCount;
+#if !defined(PCBTARANIS)
+    pxx.serialByte = prefix.serialByte;
+    pxx.serialBitCount = prefix.serialBitCount;
+#endif
+    return;
+  }
 
-  modulePulsesData[port].pxx.ptr = modulePulsesData[port].pxx.pulses;
-  modulePulsesData[port].pxx.pcmValue = 0 ;
-  modulePulsesData[port].pxx.pcmCrc = 0;
-  modulePulsesData[port].pxx.pcmOnesCount = 0;
+  pxx.ptr = pxx.pulses;
+  pxx.pcmValue = 0;
+  pxx.pcmCrc = 0;
+  pxx.pcmOnesCount = 0;
 
   /* Preamble */
-  putPcmPart(0, port);
-  putPcmPart(0, port);
-  putPcmPart(0, port);
-  putPcmPart(0, port);
+  putPcmBits(0, 4, port);
 
   /* Sync */
   putPcmHead(port);
 
   /* Rx Number */
-  putPcmByte(g_model.header.modelId[port], port);
+  putPcmByte(modelId, port);
+
+  prefix.valid = true;
+  prefix.modelId = modelId;
+  prefix.length = pxx.ptr - pxx.pulses;
+  prefix.pcmValue = pxx.pcmValue;
+  prefix.pcmCrc = pxx.pcmCrc;
+  prefix.pcmOnesCount = pxx.pcmOnesCount;
+#if !defined(PCBTARANIS)
+  prefix.serialByte = pxx.serialByte;
+  prefix.serialBitCount = pxx.serialBitCount;
+#endif
+}
+
+void setupPulsesPXX(unsigned int port)
+{
+  uint16_t chan=0, chan_low=0;
+
+  /* Preamble, Sync and Rx Number */
+  putPcmPrefix(port);
 
   /* FLAG1 */
   uint8_t flag1 = (g_model.moduleData[port].rfProtocol << 6);
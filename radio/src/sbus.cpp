@@ -38,6 +38,7 @@
 #include "sbus.h"
 
 #define SBUS_FRAME_GAP_DELAY   1000 // 500uS
+#define SBUS_FIFO_SIZE         32
 
 #define SBUS_START_BYTE        0x0F
 #define SBUS_FLAGS_IDX         23
@@ -49,11 +50,33 @@
 
 #define SBUS_CH_CENTER        0x3E0
 
-Fifo<32> sbusFifo;
+Fifo<SBUS_FIFO_SIZE> sbusFifo;
 uint8_t SbusFrame[SBUS_MAX_FRAME_SIZE];
 uint16_t SbusTimer ;
 uint8_t SbusIndex = 0 ;
 
+// A receiver which detects the idle line (the serial port DMA) gives the end
+// of each frame, the bytes only reach the fifo by chunks and the time gap can't
+// be used there. A frame where bytes were dropped (fifo overrun, bytes received
+// with an error) is not used.
+#define SBUS_NO_FRAME_END      0xFF
+bool sbusIdleFraming = false;
+volatile uint8_t sbusFrameEnd = SBUS_NO_FRAME_END;
+uint8_t sbusOverruns = 0;
+bool sbusFrameDropped = false;
+
+void sbusSetIdleFraming(bool enable)
+{
+  sbusIdleFraming = enable;
+  sbusFrameEnd = SBUS_NO_FRAME_END;
+}
+
+// called from the receive interrupt, once the bytes up to fifoIndex are in the fifo
+void sbusFrameReceived(uint32_t fifoIndex)
+{
+  sbusFrameEnd = fifoIndex;
+}
+
 // Range for pulses (ppm input) is [-512:+512]
 void processSbusFrame(uint8_t * sbus, int16_t * pulses, uint32_t size)
 {
@@ -90,25 +113,68 @@ void processSbusFrame(uint8_t * sbus, int16_t * pulses, uint32_t size)
 
 void processSbusInput()
 {
-  uint8_t rxchar;
+  uint8_t * data;
+  uint32_t count;
   uint32_t active = 0;
-  while (sbusFifo.pop(rxchar)) {
-    active = 1;
-    SbusFrame[SbusIndex++] = rxchar;
-    if (SbusIndex > SBUS_MAX_FRAME_SIZE-1) {
-      SbusIndex = SBUS_MAX_FRAME_SIZE-1;
+  uint32_t end = SBUS_NO_FRAME_END;
+  bool frameEnd = false;
+
+  if (sbusIdleFraming) {
+    __disable_irq();
+    end = sbusFrameEnd;
+    sbusFrameEnd = SBUS_NO_FRAME_END;
+    __enable_irq();
+  }
+
+  while ((count = sbusFifo.readSpan(data)) > 0 || end != SBUS_NO_FRAME_END) {
+    if (end != SBUS_NO_FRAME_END) {
+      uint32_t toEnd = (end - (data - sbusFifo.buffer())) & (SBUS_FIFO_SIZE-1);
+      if (toEnd <= count) {
+        count = toEnd;
+        frameEnd = true;
+      }
+    }
+    if (count > 0) {
+      active = 1;
+      // bytes beyond the frame size keep overwriting the last one
+      uint32_t len = min<uint32_t>(count, SBUS_MAX_FRAME_SIZE - SbusIndex);
+      memcpy(&SbusFrame[SbusIndex], data, len);
+      if (count > len) {
+        SbusFrame[SBUS_MAX_FRAME_SIZE-1] = data[count-1];
+      }
+      SbusIndex = min<uint32_t>(SbusIndex + count, SBUS_MAX_FRAME_SIZE-1);
+      sbusFifo.skip(count);
+    }
+    if (frameEnd || count == 0) {
+      break;
     }
   }
-  if (active) {
-    SbusTimer = getTmr2MHz();
+
+  uint8_t overruns = sbusFifo.getOverruns();
+  if (overruns != sbusOverruns) {
+    // the bytes read may be mixed with newer ones, this frame and the next one are dropped
+    sbusOverruns = overruns;
+    SbusIndex = 0;
+    sbusFrameDropped = true;
     return;
   }
-  else {
-    if (SbusIndex) {
-      if ((uint16_t) (getTmr2MHz() - SbusTimer) > SBUS_FRAME_GAP_DELAY) {
+
+  if (sbusIdleFraming) {
+    if (frameEnd) {
+      if (!sbusFrameDropped) {
         processSbusFrame(SbusFrame, ppmInput, SbusIndex);
-        SbusIndex = 0;
       }
+      SbusIndex = 0;
+      sbusFrameDropped = false;
+    }
+  }
+  else if (active) {
+    SbusTimer = getTmr2MHz();
+  }
+  else if (SbusIndex) {
+    if ((uint16_t) (getTmr2MHz() - SbusTimer) > SBUS_FRAME_GAP_DELAY) {
+      processSbusFrame(SbusFrame, ppmInput, SbusIndex);
+      SbusIndex = 0;
     }
   }
 }
@@ -42,6 +42,8 @@
 #define SBUS_MAX_FRAME_SIZE   28
 
 void processSbusInput();
+void sbusSetIdleFraming(bool enable);
+void sbusFrameReceived(uint32_t fifoIndex);
 void processSbusFrame(uint8_t * sbus, int16_t * pulses, uint32_t size);
 
 #endif // _SBUS_H_
@@ -50,6 +50,16 @@ void serialPutc(char c)
 #endif
 }
 
+// Sends as many bytes as the serial port accepts without blocking, returns their count
+uint32_t serialWrite(const uint8_t * data, uint32_t count)
+{
+#if defined(USB_SERIAL)
+  return usbSerialWrite(data, count);
+#else
+  return serial2Write(data, count);
+#endif
+}
+
 void serialPrintf(const char * format, ...)
 {
   va_list arglist;
@@ -44,6 +44,7 @@ extern "C" {
 void serialPutc(char c);
 void serialPrintf(const char *format, ...);
 void serialCrlf();
+uint32_t serialWrite(const uint8_t * data, uint32_t count);
 
 #ifdef __cplusplus
 }
@@ -101,12 +101,32 @@ char simuSdDirectory[1024] = "";
 uint8_t eeprom[EESIZE_SIMU];
 sem_t *eeprom_write_sem;
 
+#if defined(SDCARD)
+// Access time of the simulated SD card for each 512 bytes block, in ms (SIMU_SD_LATENCY environment variable),
+// to see how the tasks behave with a slow card
+uint32_t simuSdLatency = 0;
+
+void simuSdDelay(uint32_t blocks)
+{
+  if (simuSdLatency) {
+    sleep(simuSdLatency * blocks);
+  }
+}
+#endif
+
 void simuInit()
 {
   for (int i = 0; i <= 17; i++) {
     simuSetSwitch(i, 0);
     simuSetKey(i, false);  // a little dirty, but setting keys that don't exist is perfectly OK here
   }
+
+#if defined(SDCARD)
+  const char * latency = getenv("SIMU_SD_LATENCY");
+  if (latency) {
+    simuSdLatency = atoi(latency);
+  }
+#endif
 }
 
 #define NEG_CASE(sw_or_key, pin, mask) \
@@ -320,65 +340,83 @@ void *eeprom_write_function(void *)
 uint8_t main_thread_running = 0;
 char * main_thread_error = NULL;
 extern void opentxStart();
-void *main_thread(void *)
-{
-#ifdef SIMU_EXCEPTIONS
-  signal(SIGFPE, sig);
-  signal(SIGSEGV, sig);
-
-  try {
-#endif
 
+void simuMainInit()
+{
 #if defined(CPUARM)
-    stackPaint();
+  stackPaint();
 #endif
-    
-    s_current_protocol[0] = 255;
 
-    menuLevel = 0;
-    menuHandlers[0] = menuMainView;
-    menuHandlers[1] = menuModelSelect;
+  s_current_protocol[0] = 255;
+
+  menuLevel = 0;
+  menuHandlers[0] = menuMainView;
+  menuHandlers[1] = menuModelSelect;
 
-    eeReadAll(); // load general setup and selected model
+  eeReadAll(); // load general setup and selected model
 
 #if defined(SIMU_DISKIO)
-    f_mount(&g_FATFS_Obj, "", 1);
-    // call sdGetFreeSectors() now because f_getfree() takes a long time first time it's called
-    sdGetFreeSectors();
+  f_mount(&g_FATFS_Obj, "", 1);
+  // call sdGetFreeSectors() now because f_getfree() takes a long time first time it's called
+  sdGetFreeSectors();
 #endif
 
 #if defined(CPUARM) && defined(SDCARD)
-    referenceSystemAudioFiles();
+  referenceSystemAudioFiles();
 #endif
 
-    if (g_eeGeneral.backlightMode != e_backlight_mode_off) backlightOn(); // on Tx start turn the light on
+  if (g_eeGeneral.backlightMode != e_backlight_mode_off) backlightOn(); // on Tx start turn the light on
 
-    if (main_thread_running == 1) {
-      opentxStart();
-    }
-    else {
+  if (main_thread_running == 1) {
+    opentxStart();
+  }
+  else {
 #if defined(CPUARM)
-      eeLoadModel(g_eeGeneral.currModel);
+    eeLoadModel(g_eeGeneral.currModel);
 #endif
-    }
+  }
 
-    s_current_protocol[0] = 0;
+  s_current_protocol[0] = 0;
+}
 
-    while (main_thread_running) {
+void simuMainLoop()
+{
 #if defined(CPUARM)
-      doMixerCalculations();
+  TRACE_TIMING_EVENT(timing_mixer_start, 0);
+  doMixerCalculations();
+  TRACE_TIMING_EVENT(timing_mixer_end, 0);
 #if defined(FRSKY) || defined(MAVLINK)
-      telemetryWakeup();
+  telemetryWakeup();
 #endif
-      checkTrims();
+  checkTrims();
 #endif
-      perMain();
-      sleep(10/*ms*/);
-    }
+  perMain();
+}
 
+void simuMainClose()
+{
 #if defined(CPUARM)
-    opentxClose();
+  opentxClose();
 #endif
+}
+
+void *main_thread(void *)
+{
+#ifdef SIMU_EXCEPTIONS
+  signal(SIGFPE, sig);
+  signal(SIGSEGV, sig);
+
+  try {
+#endif
+
+    simuMainInit();
+
+    while (main_thread_running) {
+      simuMainLoop();
+      sleep(10/*ms*/);
+    }
+
+    simuMainClose();
 
 #ifdef SIMU_EXCEPTIONS
   }
@@ -401,8 +439,7 @@ void *main_thread(void *)
 #define getcwd _getcwd
 #endif
 
-pthread_t main_thread_pid;
-void StartMainThread(bool tests)
+void simuStartCommon(bool tests)
 {
 #if defined(SDCARD)
   if (strlen(simuSdDirectory) == 0)
@@ -434,6 +471,12 @@ void StartMainThread(bool tests)
 #endif
   
   main_thread_running = (tests ? 1 : 2);
+}
+
+pthread_t main_thread_pid;
+void StartMainThread(bool tests)
+{
+  simuStartCommon(tests);
   pthread_create(&main_thread_pid, NULL, &main_thread, NULL);
 }
 
@@ -443,6 +486,67 @@ void StopMainThread()
   pthread_join(main_thread_pid, NULL);
 }
 
+/*
+  Lockstep mode: no main thread, the caller drives the firmware one 10ms period
+  at a time with StepMainLockstep(), as fast as it wants (headless runs, tests).
+  g_tmr10ms is only incremented by these steps, so the simulated time doesn't
+  depend on the host speed.
+*/
+bool StartMainLockstep(bool tests)
+{
+  simuStartCommon(tests);
+
+#ifdef SIMU_EXCEPTIONS
+  signal(SIGFPE, sig);
+  signal(SIGSEGV, sig);
+
+  try {
+#endif
+    simuMainInit();
+#ifdef SIMU_EXCEPTIONS
+  }
+  catch (...) {
+    main_thread_running = 0;
+  }
+#endif
+
+  return main_thread_running;
+}
+
+bool StepMainLockstep()
+{
+  if (!main_thread_running)
+    return false;
+
+#ifdef SIMU_EXCEPTIONS
+  try {
+#endif
+    per10ms();
+    simuMainLoop();
+#ifdef SIMU_EXCEPTIONS
+  }
+  catch (...) {
+    main_thread_running = 0;
+  }
+#endif
+
+  return main_thread_running;
+}
+
+void StopMainLockstep()
+{
+  if (main_thread_running) {
+    main_thread_running = 0;
+    simuMainClose();
+  }
+
+#if defined(SIMU_DISKIO)
+  if (diskImage) {
+    fclose(diskImage);
+  }
+#endif
+}
+
 #if defined(CPUARM)
 
 struct SimulatorAudio {
@@ -832,6 +936,7 @@ FRESULT f_open (FIL * fil, const TCHAR *name, BYTE flag)
 FRESULT f_read (FIL* fil, void* data, UINT size, UINT* read)
 {
   if (fil && fil->fs) {
+    simuSdDelay((size + 511) / 512);
     *read = fread(data, 1, size, (FILE*)fil->fs);
     fil->fptr += *read;
     // TRACE("fread(%p) %u, %u", fil->fs, size, *read);
@@ -842,6 +947,7 @@ FRESULT f_read (FIL* fil, void* data, UINT size, UINT* read)
 FRESULT f_write (FIL* fil, const void* data, UINT size, UINT* written)
 {
   if (fil && fil->fs) {
+    simuSdDelay((size + 511) / 512);
     *written = fwrite(data, 1, size, (FILE*)fil->fs);
     fil->fptr += size;
     // TRACE("fwrite(%p) %u, %u", fil->fs, size, *written);
@@ -1100,6 +1206,7 @@ DRESULT disk_read (BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
   if (diskImage == 0) return RES_NOTRDY;
   traceDiskStatus();
   TRACE("disk_read(%u, %p, %u, %u)", pdrv, buff, sector, count);
+  simuSdDelay(count);
   fseek(diskImage, sector*512, SEEK_SET);
   fread(buff, count, 512, diskImage);
   return RES_OK;
@@ -1110,6 +1217,7 @@ DRESULT disk_write (BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
   if (diskImage == 0) return RES_NOTRDY;
   traceDiskStatus();
   TRACE("disk_write(%u, %p, %u, %u)", pdrv, buff, sector, count);
+  simuSdDelay(count);
   fseek(diskImage, sector*512, SEEK_SET);
   fwrite(buff, count, 512, diskImage);
   return RES_OK;
@@ -1215,6 +1323,11 @@ uint32_t sdGetSpeed()
 bool lcd_refresh = true;
 display_t lcd_buf[DISPLAY_BUF_SIZE];
 
+// One bit per LCD_W bytes line of lcd_buf which changed since the last lcdGetDamage()
+#define LCD_DAMAGE_LINES      (DISPLAY_BUF_SIZE / LCD_W)
+#define LCD_DAMAGE_LINE_ROWS  (LCD_H / LCD_DAMAGE_LINES)
+volatile uint32_t lcd_damage = (1ull << LCD_DAMAGE_LINES) - 1;
+
 void lcdSetRefVolt(uint8_t val)
 {
 }
@@ -1231,10 +1344,33 @@ void lcdOff()
 
 void lcdRefresh()
 {
-  memcpy(lcd_buf, displayBuf, sizeof(lcd_buf));
+  uint32_t damage = 0;
+  for (int line=0; line<LCD_DAMAGE_LINES; line++) {
+    if (memcmp(&lcd_buf[line*LCD_W], &displayBuf[line*LCD_W], LCD_W)) {
+      memcpy(&lcd_buf[line*LCD_W], &displayBuf[line*LCD_W], LCD_W);
+      damage |= (1u << line);
+    }
+  }
+  if (damage) {
+    __sync_fetch_and_or(&lcd_damage, damage);
+  }
   lcd_refresh = true;
 }
 
+bool lcdGetDamage(int & firstRow, int & lastRow)
+{
+  uint32_t damage = __sync_fetch_and_and(&lcd_damage, 0);
+  if (!damage) {
+    return false;
+  }
+  int first = 0, last = LCD_DAMAGE_LINES-1;
+  while (!(damage & (1u << first))) first++;
+  while (!(damage & (1u << last))) last--;
+  firstRow = first * LCD_DAMAGE_LINE_ROWS;
+  lastRow = (last+1) * LCD_DAMAGE_LINE_ROWS - 1;
+  return true;
+}
+
 void telemetryPortInit()
 {
 }
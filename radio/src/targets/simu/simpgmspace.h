@@ -361,6 +361,9 @@ void simuSetSwitch(uint8_t swtch, int8_t state);
 
 void StartMainThread(bool tests=true);
 void StopMainThread();
+bool StartMainLockstep(bool tests=true);
+bool StepMainLockstep();
+void StopMainLockstep();
 void StartEepromThread(const char *filename="eeprom.bin");
 void StopEepromThread();
 #if defined(SIMU_AUDIO) && defined(CPUARM)
@@ -178,6 +178,8 @@ void delay_01us(uint16_t nb);
   void sdInit(void);
   void sdDone(void);
   void sdPoll10ms(void);
+  void sdCloseIdleStream(void);
+  void SD_StopStream(void);
   #define sdMountPoll()
   uint32_t sdMounted(void);
   #define SD_CARD_PRESENT()       (~SD_GPIO_PRESENT->IDR & SD_GPIO_PIN_PRESENT)
@@ -292,6 +294,7 @@ int usbPlugged(void);
 void usbInit(void);
 void usbDeInit(void);
 void usbSerialPutc(uint8_t c);
+uint32_t usbSerialWrite(const uint8_t * data, uint32_t count);
 
 #if defined(__cplusplus) && !defined(SIMU)
 }
@@ -334,6 +337,7 @@ void hapticOff(void);
 #define DEBUG_BAUDRATE                 115200
 void serial2Init(unsigned int mode, unsigned int protocol);
 void serial2Putc(char c);
+uint32_t serial2Write(const uint8_t * data, uint32_t count);
 #define serial2TelemetryInit(protocol) serial2Init(UART_MODE_TELEMETRY, protocol)
 void serial2SbusInit(void);
 void serial2Stop(void);
@@ -472,7 +472,9 @@ int main()
 
       if (state == ST_USB) {
         lcd_putsLeft(4*FH, "\026USB Connected");
+        sdCloseIdleStream();
         if (usbPlugged() == 0) {
+          SD_StopStream();
           vpos = 0;
           if (unlocked) {
             lockFlash();
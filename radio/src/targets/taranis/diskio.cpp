@@ -116,6 +116,14 @@ DWORD Timer1, Timer2;   /* 100Hz decrement timers */
 
 BYTE CardType;                  /* Card type flags */
 
+/* Multiple block transfer left open by the sequential accesses */
+enum stream_mode { STREAM_NONE, STREAM_READ, STREAM_WRITE };
+static BYTE StreamMode = STREAM_NONE;
+static DWORD StreamSector;      /* Next sector of the open transfer */
+static volatile
+BYTE StreamTimer;               /* 100Hz decrement timer, the open transfer is closed when it expires */
+#define SD_STREAM_IDLE_TIMEOUT  50      /* 500ms */
+
 enum speed_setting { INTERFACE_SLOW, INTERFACE_FAST };
 
 static void interface_speed( enum speed_setting speed )
@@ -194,6 +202,32 @@ BYTE rcvr_spi (void)
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Let the other tasks run while the card is busy                        */
+/*-----------------------------------------------------------------------*/
+
+#if !defined(BOOT)
+static OS_FlagID sdFlag;                  /* Set by the DMA interrupt */
+static bool sdFlagCreated = false;
+
+/* The card is initialized before the flag exists and the USB mass storage accesses it from an interrupt, then we poll */
+static inline bool sd_can_yield()
+{
+  return sdFlagCreated && __get_IPSR() == 0;
+}
+#endif
+
+#define SD_BUSY_POLLS   1000    /* About 1ms at 10.5MHz, the usual read latency, before giving the CPU to the other tasks */
+
+static inline void sd_busy_yield(UINT polls)
+{
+#if !defined(BOOT)
+  if (polls > SD_BUSY_POLLS && sd_can_yield()) {
+    CoTickDelay(1);
+  }
+#endif
+}
+
 /*-----------------------------------------------------------------------*/
 /* Wait for card ready                                                   */
 /*-----------------------------------------------------------------------*/
@@ -203,9 +237,9 @@ static BYTE wait_ready (void)
 
   Timer2 = 50;    /* Wait for ready in timeout of 500ms */
   rcvr_spi();
-  do {
-    res = rcvr_spi();
-  } while ((res != 0xFF) && Timer2);
+  for (UINT polls=0; ((res = rcvr_spi()) != 0xFF) && Timer2; polls++) {
+    sd_busy_yield(polls);
+  }
 
   return res;
 }
@@ -235,11 +269,23 @@ void release_spi (void)
 WORD rw_workbyte[1] __DMA;
 #endif
 
+#define SD_DMA_TIMEOUT  10      /* 20ms, a block takes 0.4ms */
+
+extern "C" void SD_DMA_RX_IRQHandler(void)
+{
+  CoEnterISR();
+  if (DMA_GetITStatus(SD_DMA_Stream_SPI_RX, SD_DMA_IT_SPI_TC_RX)) {
+    DMA_ClearITPendingBit(SD_DMA_Stream_SPI_RX, SD_DMA_IT_SPI_TC_RX);
+    isr_SetFlag(sdFlag);
+  }
+  CoExitISR();
+}
+
 /*-----------------------------------------------------------------------*/
 /* Transmit/Receive Block using DMA (Platform dependent. STM32 here)     */
 /*-----------------------------------------------------------------------*/
 static
-void stm32_dma_transfer(
+BOOL stm32_dma_transfer(
   BOOL receive,   /* FALSE for buff->SPI, TRUE for SPI->buff               */
   const BYTE *buff, /* receive TRUE  : 512 byte data block to be transmitted
                receive FALSE : Data buffer to store received data    */
@@ -296,6 +342,13 @@ void stm32_dma_transfer(
 #endif
   }
 
+  /* The RX stream ends last, its interrupt wakes us up */
+  bool yield = sd_can_yield();
+  if (yield) {
+    CoClearFlag(sdFlag);
+    DMA_ITConfig(SD_DMA_Stream_SPI_RX, DMA_IT_TC, ENABLE);
+  }
+
   /* Enable DMA Channels */
   DMA_Cmd(SD_DMA_Stream_SPI_RX, ENABLE);
   DMA_Cmd(SD_DMA_Stream_SPI_TX, ENABLE);
@@ -303,8 +356,15 @@ void stm32_dma_transfer(
   /* Enable SPI TX/RX request */
   SPI_I2S_DMACmd(SD_SPI, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
 
-  while (DMA_GetFlagStatus(SD_DMA_Stream_SPI_TX, SD_DMA_FLAG_SPI_TC_TX) == RESET) { ; }
-  while (DMA_GetFlagStatus(SD_DMA_Stream_SPI_RX, SD_DMA_FLAG_SPI_TC_RX) == RESET) { ; }
+  BOOL result = TRUE;
+  if (yield) {
+    result = (CoWaitForSingleFlag(sdFlag, SD_DMA_TIMEOUT) == E_OK);
+    DMA_ITConfig(SD_DMA_Stream_SPI_RX, DMA_IT_TC, DISABLE);
+  }
+  else {
+    while (DMA_GetFlagStatus(SD_DMA_Stream_SPI_RX, SD_DMA_FLAG_SPI_TC_RX) == RESET) { ; }
+  }
+  while (result && DMA_GetFlagStatus(SD_DMA_Stream_SPI_TX, SD_DMA_FLAG_SPI_TC_TX) == RESET) { ; }
 
   /* Disable DMA Channels */
   DMA_Cmd(SD_DMA_Stream_SPI_RX, DISABLE);
@@ -312,6 +372,8 @@ void stm32_dma_transfer(
 
   /* Disable SPI RX/TX request */
   SPI_I2S_DMACmd(SD_SPI, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+
+  return result;
 }
 #endif /* SD_USE_DMA */
 
@@ -384,6 +446,7 @@ void power_off (void)
   GPIO_InitTypeDef GPIO_InitStructure;
 
   if (!(Stat & STA_NOINIT)) {
+    SD_StopStream();
     SD_SELECT();
     wait_ready();
     release_spi();
@@ -410,6 +473,8 @@ void power_off (void)
 
 #if defined(SD_USE_DMA) && defined(STM32F4)
   uint8_t sd_buff[512] __DMA;
+  /* The DMA can't reach the CCM where the data and stacks are, only the buffers in the main RAM are used directly */
+  #define IS_DMA_BUFFER(buff)  ((DWORD)(buff) >= 0x20000000)
 #endif
 
 static
@@ -422,20 +487,31 @@ BOOL rcvr_datablock (
 
 
   Timer1 = 10;
-  do {                                                    /* Wait for data packet in timeout of 100ms */
-    token = rcvr_spi();
-  } while ((token == 0xFF) && Timer1);
+  for (UINT polls=0; ((token = rcvr_spi()) == 0xFF) && Timer1; polls++) {  /* Wait for data packet in timeout of 100ms */
+    sd_busy_yield(polls);
+  }
   if(token != 0xFE) {
     TRACE_SD_CARD_EVENT(1, sd_rcvr_datablock, ((uint32_t)(Timer1) << 24) + ((uint32_t)(btr) << 8) + token);
     spi_reset();
     return FALSE; /* If not valid data token, return with error */
   }
 
-#if defined(SD_USE_DMA) && defined(STM32F4)
-  stm32_dma_transfer(TRUE, sd_buff, btr);
-  memcpy(buff, sd_buff, btr);
-#elif defined(SD_USE_DMA)
-  stm32_dma_transfer(TRUE, buff, btr);
+#if defined(SD_USE_DMA)
+#if defined(STM32F4)
+  BYTE * dmaBuff = IS_DMA_BUFFER(buff) ? buff : sd_buff;
+#else
+  BYTE * dmaBuff = buff;
+#endif
+  if (!stm32_dma_transfer(TRUE, dmaBuff, btr)) {
+    TRACE_SD_CARD_EVENT(1, sd_rcvr_datablock, ((uint32_t)(btr) << 8) + token);
+    spi_reset();
+    return FALSE;
+  }
+#if defined(STM32F4)
+  if (dmaBuff != buff) {
+    memcpy(buff, sd_buff, btr);
+  }
+#endif
 #else
   do {                                                    /* Receive the data block into buffer */
     rcvr_spi_m(buff++);
@@ -479,11 +555,19 @@ BOOL xmit_datablock (
   xmit_spi(token);                                        /* transmit data token */
   if (token != 0xFD) {    /* Is data token */
 
-#if defined(SD_USE_DMA) && defined(STM32F4)
-  memcpy(sd_buff, buff, 512);
-  stm32_dma_transfer(FALSE, sd_buff, 512);
-#elif defined(SD_USE_DMA)
-  stm32_dma_transfer(FALSE, buff, 512);
+#if defined(SD_USE_DMA)
+    const BYTE * dmaBuff = buff;
+#if defined(STM32F4)
+    if (!IS_DMA_BUFFER(buff)) {
+      memcpy(sd_buff, buff, 512);
+      dmaBuff = sd_buff;
+    }
+#endif
+    if (!stm32_dma_transfer(FALSE, dmaBuff, 512)) {
+      TRACE_SD_CARD_EVENT(1, sd_xmit_datablock_rcvr_spi, token);
+      spi_reset();
+      return FALSE;
+    }
 #else
     wc = 0;
     do {                                                    /* transmit the 512 byte data block to MMC */
@@ -595,6 +679,7 @@ DSTATUS disk_initialize (
   if (Stat & STA_NODISK) return Stat;     /* No card in the socket */
 
   power_on();                                                     /* Force socket power on and initialize interface */
+  StreamMode = STREAM_NONE;                                       /* The card is reset, the open transfer is lost */
   interface_speed(INTERFACE_SLOW);
   for (n = 10; n; n--) rcvr_spi();        /* 80 dummy clocks */
 
@@ -649,12 +734,107 @@ DSTATUS disk_status (
 }
 
 
+/*-----------------------------------------------------------------------*/
+/* Sequential Sector(s) access (USB mass storage)                        */
+/*-----------------------------------------------------------------------*/
+/* The multiple block transfer stays open after the last sector. When the
+   next access continues at the following sector in the same direction,
+   it goes on without a new command, STOP_TRANSMISSION and busy wait.
+   Any other access to the card closes it first, and so do the USB eject
+   and disconnection, or sdCloseIdleStream() after 500ms without access  */
+
+void SD_StopStream()
+{
+  if (StreamMode == STREAM_READ) {
+    send_cmd(CMD12, 0);                             /* STOP_TRANSMISSION */
+    release_spi();
+  }
+  else if (StreamMode == STREAM_WRITE) {
+    if (!xmit_datablock(0, 0xFD)) {                 /* STOP_TRAN token */
+      TRACE_SD_CARD_EVENT(1, sd_SD_WriteSectors, StreamSector & 0x00FFFFFF);
+    }
+    release_spi();
+  }
+  StreamMode = STREAM_NONE;
+}
+
+int8_t SD_ReadSectorsStream(uint8_t *buff, uint32_t sector, uint32_t count)
+{
+  if (StreamMode != STREAM_READ || sector != StreamSector) {
+    SD_StopStream();
+    if (send_cmd(CMD18, (CardType & CT_BLOCK) ? sector : sector * 512) != 0) {     /* READ_MULTIPLE_BLOCK */
+      TRACE_SD_CARD_EVENT(1, sd_SD_ReadSectors, (count << 24) + (sector & 0x00FFFFFF));
+      spi_reset();
+      release_spi();
+      return -1;
+    }
+    StreamMode = STREAM_READ;
+    StreamSector = sector;
+  }
+
+  for (; count; count--) {
+    if (!rcvr_datablock(buff, 512)) {
+      TRACE_SD_CARD_EVENT(1, sd_SD_ReadSectors, (count << 24) + (StreamSector & 0x00FFFFFF));
+      SD_StopStream();
+      return -1;
+    }
+    buff += 512;
+    StreamSector++;
+  }
+
+  StreamTimer = SD_STREAM_IDLE_TIMEOUT;
+  return 0;
+}
+
+int8_t SD_WriteSectorsStream(const uint8_t *buff, uint32_t sector, uint32_t count)
+{
+  if (StreamMode != STREAM_WRITE || sector != StreamSector) {
+    SD_StopStream();
+    if (send_cmd(CMD25, (CardType & CT_BLOCK) ? sector : sector * 512) != 0) {     /* WRITE_MULTIPLE_BLOCK */
+      TRACE_SD_CARD_EVENT(1, sd_SD_WriteSectors, (count << 24) + (sector & 0x00FFFFFF));
+      spi_reset();
+      release_spi();
+      return -1;
+    }
+    StreamMode = STREAM_WRITE;
+    StreamSector = sector;
+  }
+
+  for (; count; count--) {
+    if (!xmit_datablock(buff, 0xFC)) {
+      TRACE_SD_CARD_EVENT(1, sd_SD_WriteSectors, (count << 24) + (StreamSector & 0x00FFFFFF));
+      SD_StopStream();
+      return -1;
+    }
+    buff += 512;
+    StreamSector++;
+  }
+
+  StreamTimer = SD_STREAM_IDLE_TIMEOUT;
+  return 0;
+}
+
+/* Called from a task, the USB interrupt which runs the transfers is masked
+   meanwhile                                                             */
+void sdCloseIdleStream()
+{
+  if (StreamMode != STREAM_NONE && StreamTimer == 0) {
+    NVIC_DisableIRQ(OTG_FS_IRQn);
+    if (StreamMode != STREAM_NONE && StreamTimer == 0) {
+      SD_StopStream();
+    }
+    NVIC_EnableIRQ(OTG_FS_IRQn);
+  }
+}
+
 /*-----------------------------------------------------------------------*/
 /* Read Sector(s)                                                        */
 /*-----------------------------------------------------------------------*/
 
 int8_t SD_ReadSectors(uint8_t *buff, uint32_t sector, uint32_t count)
 {
+  SD_StopStream();
+
   if (!(CardType & CT_BLOCK)) sector *= 512;      /* Convert to byte address if needed */
 
   if (count == 1) {       /* Single block read */
@@ -709,6 +889,8 @@ DRESULT disk_read (
 
 int8_t SD_WriteSectors(const uint8_t *buff, uint32_t sector, uint32_t count)
 {
+  SD_StopStream();
+
   if (!(CardType & CT_BLOCK)) sector *= 512;      /* Convert to byte address if needed */
 
   if (count == 1) {       /* Single block write */
@@ -803,6 +985,8 @@ DRESULT disk_ioctl (
       return RES_NOTRDY;
     }
 
+    SD_StopStream();
+
     switch (ctrl) {
     case CTRL_SYNC :                /* Make sure that no pending write process */
       SD_SELECT();
@@ -935,6 +1119,8 @@ void sdPoll10ms()
   if (n) Timer1 = --n;
   n = Timer2;
   if (n) Timer2 = --n;
+  n = StreamTimer;
+  if (n) StreamTimer = --n;
 
   ns = pv;
   pv = socket_is_empty() | socket_is_write_protected();   /* Sample socket switch */
@@ -980,6 +1166,15 @@ void sdInit(void)
     return;
   }
 
+  if (!sdFlagCreated) {
+    sdFlag = CoCreateFlag(true, false);
+    if (sdFlag != (OS_FlagID)E_CREATE_FAIL) {
+      sdFlagCreated = true;
+      NVIC_SetPriority(SD_DMA_RX_IRQn, 8);
+      NVIC_EnableIRQ(SD_DMA_RX_IRQn);
+    }
+  }
+
   if (f_mount(&g_FATFS_Obj, "", 1) == FR_OK) {
     // call sdGetFreeSectors() now because f_getfree() takes a long time first time it's called
     sdGetFreeSectors();
@@ -999,6 +1194,7 @@ void sdDone()
 {
   if (sdMounted()) {
     audioQueue.stopSD();
+    bmpCacheClear();
 #if defined(SPORT_FILE_LOG)
     f_close(&g_telemetryFile);
 #endif
@@ -345,7 +345,7 @@
 #define TRAINER_GPIO_AF                 GPIO_AF_TIM3
 
 // Serial Port
-#define SERIAL_RCC_AHB1Periph           RCC_AHB1Periph_GPIOB
+#define SERIAL_RCC_AHB1Periph           (RCC_AHB1Periph_GPIOB | RCC_AHB1Periph_DMA1)
 #define SERIAL_RCC_APB1Periph           RCC_APB1Periph_USART3
 #define SERIAL_GPIO                     GPIOB
 #define SERIAL_GPIO_PIN_TX              GPIO_Pin_10 // PB.10
@@ -356,6 +356,11 @@
 #define SERIAL_USART                    USART3
 #define SERIAL_USART_IRQHandler         USART3_IRQHandler
 #define SERIAL_USART_IRQn               USART3_IRQn
+#define SERIAL_DMA_Stream_RX            DMA1_Stream1
+#define SERIAL_DMA_Channel_RX           DMA_SxCR_CHSEL_2 // Channel 4
+#define SERIAL_DMA_RX_IRQn              DMA1_Stream1_IRQn
+#define SERIAL_DMA_RX_IRQHandler        DMA1_Stream1_IRQHandler
+#define SERIAL_DMA_RX_FLAGS             (DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1 | DMA_LIFCR_CTEIF1 | DMA_LIFCR_CDMEIF1 | DMA_LIFCR_CFEIF1)
 
 // Telemetry
 #define TELEMETRY_RCC_AHB1Periph        RCC_AHB1Periph_GPIOD
@@ -508,6 +513,9 @@
   #define SD_DMA_Stream_SPI_TX          DMA1_Stream4
   #define SD_DMA_FLAG_SPI_TC_RX         DMA_FLAG_TCIF3
   #define SD_DMA_FLAG_SPI_TC_TX         DMA_FLAG_TCIF4
+  #define SD_DMA_IT_SPI_TC_RX           DMA_IT_TCIF3
+  #define SD_DMA_RX_IRQn                DMA1_Stream3_IRQn
+  #define SD_DMA_RX_IRQHandler          DMA1_Stream3_IRQHandler
   #define SD_DMA_Channel_SPI            DMA_Channel_0
 #endif
 
@@ -395,7 +395,9 @@ extern "C" void TIM1_CC_IRQHandler()
   INTMODULE_TIMER->SR &= ~TIM_SR_CC2IF;           // clear flag
   DMA2_Stream6->CR &= ~DMA_SxCR_EN;    // disable DMA, it will have the whole of the execution time of setupPulses() to actually stop
 
+  TRACE_TIMING_EVENT(timing_pulses_setup_start, INTERNAL_MODULE);
   setupPulses(INTERNAL_MODULE);
+  TRACE_TIMING_EVENT(timing_pulses_setup_end, INTERNAL_MODULE);
 
   if (s_current_protocol[INTERNAL_MODULE] == PROTO_PXX) {
     DMA2->HIFCR = DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6 | DMA_HIFCR_CTEIF6 | DMA_HIFCR_CDMEIF6 | DMA_HIFCR_CFEIF6;
@@ -601,7 +603,9 @@ extern "C" void TIM8_CC_IRQHandler()
   EXTMODULE_TIMER->DIER &= ~TIM_DIER_CC2IE ;         // stop this interrupt
   EXTMODULE_TIMER->SR &= ~TIM_SR_CC2IF ;                             // Clear flag
 
+  TRACE_TIMING_EVENT(timing_pulses_setup_start, EXTERNAL_MODULE);
   setupPulses(EXTERNAL_MODULE) ;
+  TRACE_TIMING_EVENT(timing_pulses_setup_end, EXTERNAL_MODULE);
 
   if (s_current_protocol[EXTERNAL_MODULE] == PROTO_PXX) {
     DMA2_Stream2->CR &= ~DMA_SxCR_EN ;              // Disable DMA
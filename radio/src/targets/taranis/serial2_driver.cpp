@@ -41,11 +41,111 @@ Fifo<512> serial2TxFifo;
 extern Fifo<512> telemetryFifo;
 extern Fifo<32> sbusFifo;
 
+#if !defined(SIMU)
+// The received bytes are written by a circular DMA straight into the fifo
+// of the current mode, the write index is updated on half / full transfer
+// and when the line goes idle. A byte received with an error can't be taken
+// out of the DMA buffer, the unread bytes are dropped instead (the consumers
+// resynchronize on their next frame).
+template <int N>
+void serial2RxDmaStart(Fifo<N> & fifo)
+{
+  fifo.clear();
+
+  SERIAL_DMA_Stream_RX->CR &= ~DMA_SxCR_EN;
+  while (SERIAL_DMA_Stream_RX->CR & DMA_SxCR_EN);
+  DMA1->LIFCR = SERIAL_DMA_RX_FLAGS;
+  SERIAL_DMA_Stream_RX->PAR = CONVERT_PTR_UINT(&SERIAL_USART->DR);
+  SERIAL_DMA_Stream_RX->M0AR = CONVERT_PTR_UINT(fifo.buffer());
+  SERIAL_DMA_Stream_RX->NDTR = N;
+  SERIAL_DMA_Stream_RX->FCR = 0; // direct mode
+  SERIAL_DMA_Stream_RX->CR = SERIAL_DMA_Channel_RX | DMA_SxCR_PL_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC | DMA_SxCR_HTIE | DMA_SxCR_TCIE;
+  SERIAL_DMA_Stream_RX->CR |= DMA_SxCR_EN;
+
+  SERIAL_USART->CR3 |= USART_CR3_DMAR | USART_CR3_EIE;
+  SERIAL_USART->CR1 |= USART_CR1_PEIE;
+  USART_ITConfig(SERIAL_USART, USART_IT_IDLE, ENABLE);
+
+  NVIC_SetPriority(SERIAL_DMA_RX_IRQn, 7);
+  NVIC_EnableIRQ(SERIAL_DMA_RX_IRQn);
+}
+
+template <int N>
+inline uint32_t serial2RxDmaUpdate(Fifo<N> & fifo, uint32_t status)
+{
+  uint32_t index = N - SERIAL_DMA_Stream_RX->NDTR;
+  fifo.setWriteIndex(index);
+  if (status & USART_FLAG_ERRORS) {
+    fifo.setOverrun();
+  }
+  return index;
+}
+
+void serial2RxDmaStop()
+{
+  NVIC_DisableIRQ(SERIAL_DMA_RX_IRQn);
+  SERIAL_USART->CR3 &= ~(USART_CR3_DMAR | USART_CR3_EIE);
+  SERIAL_USART->CR1 &= ~USART_CR1_PEIE;
+  sbusSetIdleFraming(false);
+  SERIAL_DMA_Stream_RX->CR &= ~DMA_SxCR_EN;
+  DMA1->LIFCR = SERIAL_DMA_RX_FLAGS;
+}
+
+void serial2RxWakeup(uint32_t status)
+{
+  switch (serial2Mode) {
+    case UART_MODE_TELEMETRY:
+      serial2RxDmaUpdate(telemetryFifo, status);
+      break;
+    case UART_MODE_SBUS_TRAINER:
+    {
+      uint32_t index = serial2RxDmaUpdate(sbusFifo, status);
+      if (status & USART_FLAG_IDLE) {
+        sbusFrameReceived(index);
+      }
+      break;
+    }
+#if !defined(USB_SERIAL) && defined(CLI)
+    case UART_MODE_DEBUG:
+      serial2RxDmaUpdate(cliRxFifo, status);
+      break;
+#endif
+  }
+}
+
+void serial2RxInit()
+{
+  switch (serial2Mode) {
+    case UART_MODE_TELEMETRY:
+      serial2RxDmaStart(telemetryFifo);
+      break;
+    case UART_MODE_SBUS_TRAINER:
+      serial2RxDmaStart(sbusFifo);
+      sbusSetIdleFraming(true);
+      break;
+#if !defined(USB_SERIAL) && defined(CLI)
+    case UART_MODE_DEBUG:
+      serial2RxDmaStart(cliRxFifo);
+      break;
+#endif
+    default:
+      // nobody reads the port, the bytes are dropped in the interrupt
+      USART_ITConfig(SERIAL_USART, USART_IT_RXNE, ENABLE);
+      break;
+  }
+}
+#else
+#define serial2RxInit()
+#define serial2RxDmaStop()
+#endif
+
 void uart3Setup(unsigned int baudrate)
 {
   USART_InitTypeDef USART_InitStructure;
   GPIO_InitTypeDef GPIO_InitStructure;
 
+  serial2RxDmaStop();
+
   GPIO_PinAFConfig(SERIAL_GPIO, SERIAL_GPIO_PinSource_RX, SERIAL_GPIO_AF);
   GPIO_PinAFConfig(SERIAL_GPIO, SERIAL_GPIO_PinSource_TX, SERIAL_GPIO_AF);
 
@@ -66,7 +166,7 @@ void uart3Setup(unsigned int baudrate)
   USART_Init(SERIAL_USART, &USART_InitStructure);
   USART_Cmd(SERIAL_USART, ENABLE);
 
-  USART_ITConfig(SERIAL_USART, USART_IT_RXNE, ENABLE);
+  serial2RxInit();
   USART_ITConfig(SERIAL_USART, USART_IT_TXE, DISABLE);
 
   NVIC_SetPriority(SERIAL_USART_IRQn, 7);
@@ -75,6 +175,7 @@ void uart3Setup(unsigned int baudrate)
 
 void serial2Init(unsigned int mode, unsigned int protocol)
 {
+  serial2RxDmaStop();
   USART_DeInit(SERIAL_USART);
 
   serial2Mode = mode;
@@ -103,6 +204,15 @@ void serial2Putc(char c)
   USART_ITConfig(SERIAL_USART, USART_IT_TXE, ENABLE);
 }
 
+uint32_t serial2Write(const uint8_t * data, uint32_t count)
+{
+  uint32_t result = serial2TxFifo.push(data, count);
+  if (result > 0) {
+    USART_ITConfig(SERIAL_USART, USART_IT_TXE, ENABLE);
+  }
+  return result;
+}
+
 void serial2SbusInit()
 {
   uart3Setup(SBUS_BAUDRATE);
@@ -111,6 +221,7 @@ void serial2SbusInit()
 
 void serial2Stop()
 {
+  serial2RxDmaStop();
   USART_DeInit(SERIAL_USART);
 }
 
@@ -138,29 +249,31 @@ extern "C" void SERIAL_USART_IRQHandler(void)
     }
   }
 
-  // Receive
   uint32_t status = SERIAL_USART->SR;
-  while (status & (USART_FLAG_RXNE | USART_FLAG_ERRORS)) {
-    uint8_t data = SERIAL_USART->DR;
-
-    if (!(status & USART_FLAG_ERRORS)) {
-      switch (serial2Mode) {
-        case UART_MODE_TELEMETRY:
-          telemetryFifo.push(data);
-          break;
-        case UART_MODE_SBUS_TRAINER:
-          sbusFifo.push(data);
-          break;
-#if !defined(USB_SERIAL) && defined(CLI)
-        case UART_MODE_DEBUG:
-          cliRxFifo.push(data);
-          break;
-#endif
+
+  if (SERIAL_USART->CR3 & USART_CR3_DMAR) {
+    // Receive through the DMA, end of a burst or error
+    if (status & (USART_FLAG_IDLE | USART_FLAG_ERRORS)) {
+      // IDLE and the errors are cleared by the SR read above followed by a DR read. While
+      // a byte is still pending (RXNE) the DMA does this DR read, reading it here would lose it
+      if (!(status & USART_FLAG_RXNE)) {
+        (void)SERIAL_USART->DR;
       }
+      serial2RxWakeup(status);
     }
+    return;
+  }
 
+  // Receive, nobody reads the port
+  while (status & (USART_FLAG_RXNE | USART_FLAG_ERRORS)) {
+    (void)SERIAL_USART->DR;
     status = SERIAL_USART->SR;
   }
 }
-#endif
 
+extern "C" void SERIAL_DMA_RX_IRQHandler(void)
+{
+  DMA1->LIFCR = SERIAL_DMA_RX_FLAGS;
+  serial2RxWakeup(0);
+}
+#endif
@@ -182,6 +182,38 @@ void usbSerialPutc(uint8_t c)
   }  
 }
 
+// Copies the data straight into the buffer the IN endpoint transmits from,
+// only as much as usbSerialPutc() would accept without blocking
+uint32_t usbSerialWrite(const uint8_t * data, uint32_t count)
+{
+  // usbSerialPutc() drops everything when not connected, there is no need to wait
+  if (!cdcConnected) return count;
+
+  uint32_t txDataLen = APP_RX_DATA_SIZE + APP_Rx_ptr_in - APP_Rx_ptr_out;
+  if (txDataLen >= APP_RX_DATA_SIZE) {
+    txDataLen -= APP_RX_DATA_SIZE;
+  }
+  if (txDataLen >= (APP_RX_DATA_SIZE - CDC_DATA_MAX_PACKET_SIZE)) {
+    return 0;
+  }
+  if (count > (APP_RX_DATA_SIZE - CDC_DATA_MAX_PACKET_SIZE) - txDataLen) {
+    count = (APP_RX_DATA_SIZE - CDC_DATA_MAX_PACKET_SIZE) - txDataLen;
+  }
+
+  uint32_t ptr = APP_Rx_ptr_in;
+  uint32_t len = APP_RX_DATA_SIZE - ptr;
+  if (len > count) len = count;
+  memcpy(&APP_Rx_Buffer[ptr], data, len);
+  if (len < count) {
+    memcpy(&APP_Rx_Buffer[0], data + len, count - len);
+    ++usbWraps;
+  }
+  charsWritten += count;
+  ptr += count;
+  APP_Rx_ptr_in = (ptr >= APP_RX_DATA_SIZE ? ptr - APP_RX_DATA_SIZE : ptr);
+  return count;
+}
+
 /**
   * @brief  VCP_DataRx
   *         Data received over USB OUT endpoint is available here
@@ -61,7 +61,11 @@
 #define CDC_CMD_PACKET_SZE           8    /* Control Endpoint Packet size */
 
 #define CDC_IN_FRAME_INTERVAL        5    /* Number of frames between IN transfers */
+#if defined(CLI)
+#define APP_RX_DATA_SIZE             2048 // the CLI binary stream needs ~120kB/s at the mixer rate
+#else
 #define APP_RX_DATA_SIZE             512 // USB serial port output buffer. TODO: tune this buffer size /* Total size of IN buffer: APP_RX_DATA_SIZE*8/MAX_BAUDARATE*1000 should be > CDC_IN_FRAME_INTERVAL */
+#endif
 #define APP_FOPS                     VCP_fops
 
 #endif //__USBD_CONF__H__
@@ -105,6 +105,8 @@ int8_t STORAGE_Write (uint8_t lun,
 
 int8_t STORAGE_GetMaxLun (void);
 
+void STORAGE_Eject (uint8_t lun);
+
 USBD_STORAGE_cb_TypeDef USBD_MICRO_SDIO_fops =
 {
   STORAGE_Init,
@@ -239,7 +241,7 @@ int8_t  STORAGE_IsWriteProtected (uint8_t lun)
   * @retval Status
   */
 
-int8_t SD_ReadSectors(uint8_t *buff, uint32_t sector, uint32_t count);
+int8_t SD_ReadSectorsStream(uint8_t *buff, uint32_t sector, uint32_t count);
 
 int8_t STORAGE_Read (uint8_t lun, 
                  uint8_t *buf, 
@@ -254,7 +256,8 @@ int8_t STORAGE_Read (uint8_t lun,
   else 
 #endif
     {
-    if (SD_ReadSectors(buf, blk_addr, blk_len) != 0) {
+    // the host reads files in sequential chunks, the SD transfer is kept open between them
+    if (SD_ReadSectorsStream(buf, blk_addr, blk_len) != 0) {
       return -1;
     }
   }
@@ -270,7 +273,7 @@ int8_t STORAGE_Read (uint8_t lun,
   * @retval Status
   */
 
-int8_t SD_WriteSectors(const uint8_t *buf, uint32_t sector, uint32_t count);
+int8_t SD_WriteSectorsStream(const uint8_t *buf, uint32_t sector, uint32_t count);
 
 int8_t STORAGE_Write (uint8_t lun, 
                   uint8_t *buf, 
@@ -285,7 +288,8 @@ int8_t STORAGE_Write (uint8_t lun,
   else 
 #endif
     {
-    if (SD_WriteSectors(buf, blk_addr, blk_len) != 0)
+    // each sector is accepted by the card before we return, only the end of the multiple block write is deferred
+    if (SD_WriteSectorsStream(buf, blk_addr, blk_len) != 0)
       return -1;
   }
 
@@ -303,6 +307,19 @@ int8_t STORAGE_GetMaxLun (void)
   return STORAGE_LUN_NBR - 1;
 }
 
+/**
+  * @brief  Called by the SCSI layer when the host ejects the medium
+  * @param  lun : logical unit number
+  * @retval None
+  */
+void STORAGE_Eject (uint8_t lun)
+{
+  if (lun == 0) {
+    // end the multiple block write the host may have left open
+    SD_StopStream();
+  }
+}
+
 #if defined(BOOT)
 //------------------------------------------------------------------------------
 /**
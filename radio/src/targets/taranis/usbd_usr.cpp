@@ -119,6 +119,10 @@ void USBD_USR_DeviceConnected (void)
 */
 void USBD_USR_DeviceDisconnected (void)
 {
+#if defined(BOOT) || defined(USB_MASS_STORAGE)
+  // end the multiple block write the host may have left open
+  SD_StopStream();
+#endif
 #if !defined(BOOT) && defined(USB_MASS_STORAGE)
   NVIC_SystemReset();
 #endif
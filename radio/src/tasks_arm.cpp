@@ -65,6 +65,9 @@ TaskStack<BLUETOOTH_STACK_SIZE> bluetoothStack;
 OS_MutexID audioMutex;
 OS_MutexID mixerMutex;
 
+// not charged to the Lua scripts which were running in the menus task meanwhile
+volatile uint32_t menusTaskPreemption = 0;
+
 enum TaskIndex {
   MENU_TASK_INDEX,
   MIXER_TASK_INDEX,
@@ -139,7 +142,9 @@ void mixerTask(void * pdata)
       uint16_t t0 = getTmr2MHz();
 
       CoEnterMutexSection(mixerMutex);
+      TRACE_TIMING_EVENT(timing_mixer_start, 0);
       doMixerCalculations();
+      TRACE_TIMING_EVENT(timing_mixer_end, 0);
       CoLeaveMutexSection(mixerMutex);
 
 #if defined(FRSKY) || defined(MAVLINK)
@@ -153,6 +158,14 @@ void mixerTask(void * pdata)
 
       t0 = getTmr2MHz() - t0;
       if (t0 > maxMixerDuration) maxMixerDuration = t0 ;
+      menusTaskPreemption += t0;
+
+#if defined(CLI)
+      // outside of the measured mixer duration
+      if (cliStreamMask) {
+        cliStreamFrame();
+      }
+#endif
     }
 
     CoTickDelay(1);  // 2ms for now
@@ -300,25 +300,29 @@ void telemetryWakeup()
 #endif
 
 #if defined(PCBTARANIS)
-  uint8_t data;
+  uint8_t * data;
+  uint32_t count;
 #if defined(SPORT_FILE_LOG) && !defined(SIMU)
   static tmr10ms_t lastTime = 0;
   tmr10ms_t newTime = get_tmr10ms();
   struct gtm utm;
   gettime(&utm);
 #endif
-  while (telemetryFifo.pop(data)) {
-    processSerialData(data);
+  while ((count = telemetryFifo.readSpan(data)) > 0) {
+    for (uint32_t i=0; i<count; i++) {
+      processSerialData(data[i]);
 #if defined(SPORT_FILE_LOG) && !defined(SIMU)
-    extern FIL g_telemetryFile;
-    if (lastTime != newTime) {
-      f_printf(&g_telemetryFile, "\r\n%4d-%02d-%02d,%02d:%02d:%02d.%02d0: %02X", utm.tm_year+1900, utm.tm_mon+1, utm.tm_mday, utm.tm_hour, utm.tm_min, utm.tm_sec, g_ms100, data);
-      lastTime = newTime;
-    }
-    else {
-      f_printf(&g_telemetryFile, " %02X", data);
-    }
+      extern FIL g_telemetryFile;
+      if (lastTime != newTime) {
+        f_printf(&g_telemetryFile, "\r\n%4d-%02d-%02d,%02d:%02d:%02d.%02d0: %02X", utm.tm_year+1900, utm.tm_mon+1, utm.tm_mday, utm.tm_hour, utm.tm_min, utm.tm_sec, g_ms100, data[i]);
+        lastTime = newTime;
+      }
+      else {
+        f_printf(&g_telemetryFile, " %02X", data[i]);
+      }
 #endif
+    }
+    telemetryFifo.skip(count);
   }
 #elif defined(PCBSKY9X)
   if (telemetryProtocol == PROTOCOL_FRSKY_D_SECONDARY) {
@@ -347,12 +351,7 @@ void telemetryWakeup()
 #endif
 
 #if defined(CPUARM)
-  for (int i=0; i<MAX_SENSORS; i++) {
-    const TelemetrySensor & sensor = g_model.telemetrySensors[i];
-    if (sensor.type == TELEM_TYPE_CALCULATED) {
-      telemetryItems[i].eval(sensor);
-    }
-  }
+  evalCalculatedSensors();
 #endif
 
 #if defined(VARIO)
@@ -380,6 +379,7 @@ void telemetryWakeup()
         uint8_t lastReceived = telemetryItems[i].lastReceived;
         if (lastReceived < TELEMETRY_VALUE_TIMER_CYCLE && uint8_t(now - lastReceived) > TELEMETRY_VALUE_OLD_THRESHOLD) {
           telemetryItems[i].lastReceived = TELEMETRY_VALUE_OLD;
+          telemetryItems[i].updated();
           TelemetrySensor * sensor = & g_model.telemetrySensors[i];
           if (sensor->unit == UNIT_DATETIME) {
             telemetryItems[i].datetime.datestate = 0;
@@ -515,6 +515,7 @@ void telemetryReset()
   for (int index=0; index<MAX_SENSORS; index++) {
     telemetryItems[index].clear();
   }
+  invalidateCalculatedSensors();
 #endif
 
   frskyStreaming = 0; // reset counter only if valid frsky packets are being detected
@@ -640,6 +641,13 @@ void telemetryInit(uint8_t protocol)
     telemetryPortInit(FRSKY_SPORT_BAUDRATE);
   }
 
+#if defined(PCBTARANIS)
+  if (protocol != PROTOCOL_FRSKY_D_SECONDARY && g_eeGeneral.serial2Mode == UART_MODE_TELEMETRY) {
+    // the serial port DMA must not write into the telemetry fifo any more
+    serial2Stop();
+  }
+#endif
+
 #if defined(REVX) && !defined(SIMU)
   if (serialInversion) {
     setMFP();
@@ -347,9 +347,13 @@ bool sportWaitState(SportUpdateState state, int timeout)
     return true;
 #else
   for (int i=timeout/2; i>=0; i--) {
-    uint8_t data ;
-    while (telemetryFifo.pop(data)) {
-      processSerialData(data);
+    uint8_t * data;
+    uint32_t count;
+    while ((count = telemetryFifo.readSpan(data)) > 0) {
+      for (uint32_t i=0; i<count; i++) {
+        processSerialData(data[i]);
+      }
+      telemetryFifo.skip(count);
     }
     if (sportUpdateState == state) {
       return true;
@@ -66,8 +66,25 @@ static uint8_t data_stream_start_stop = 0;
 // Telemetry data hold
 Telemetry_Data_t telemetry_data;
 
-// *****************************************************
-static void MAVLINK_parse_char(uint8_t c);
+// Bytes received by the serial interrupt, parsed by runs in telemetryWakeup()
+#define MAVLINK_RX_FIFO_SIZE 256 // the uint8_t indexes wrap around it
+static uint8_t mavlinkRxFifo[MAVLINK_RX_FIFO_SIZE];
+static volatile uint8_t mavlinkRxWidx = 0;
+static volatile uint8_t mavlinkRxRidx = 0;
+//! Bytes dropped because the fifo was full, the parser is reset when it changes
+static volatile uint8_t mavlinkRxOverflows = 0;
+static uint8_t mavlinkRxOverflowsSeen = 0;
+
+static inline void MAVLINK_push(uint8_t byte) {
+	uint8_t next = mavlinkRxWidx + 1;
+	if (next != mavlinkRxRidx) {
+		mavlinkRxFifo[mavlinkRxWidx] = byte;
+		mavlinkRxWidx = next;
+	}
+	else {
+		mavlinkRxOverflows++;
+	}
+}
 
 #ifdef DUMP_RX_TX
 #define MAX_RX_BUFFER 16
@@ -83,12 +100,12 @@ void MAVLINK_rxhandler(uint8_t byte) {
 			mavlinkRxBuffer[mavlinkRxBufferCount++] = byte;
 		}
 	}
-	MAVLINK_parse_char(byte);
+	MAVLINK_push(byte);
 
 }
 #else
 void MAVLINK_rxhandler(uint8_t byte) {
-	MAVLINK_parse_char(byte);
+	MAVLINK_push(byte);
 }
 #endif
 
@@ -142,6 +159,7 @@ void MAVLINK_Init(void) {
 
 static inline void REC_MAVLINK_MSG_ID_STATUSTEXT(const mavlink_message_t* msg) {
 	_MAV_RETURN_char_array(msg, mav_statustext, LEN_STATUSTEXT,  1);
+	AUDIO_WARNING1();
 }
 
 /*!	\brief System status including cpu load, battery status and communication status.
@@ -406,181 +424,165 @@ static inline void REC_MAVLINK_MSG_ID_PARAM_VALUE(const mavlink_message_t* msg)
 }
 #endif
 
-static inline void handleMessage(mavlink_message_t* p_rxmsg) {
-	switch (p_rxmsg->msgid) {
-	case MAVLINK_MSG_ID_HEARTBEAT:
-		REC_MAVLINK_MSG_ID_HEARTBEAT(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_STATUSTEXT:
-		REC_MAVLINK_MSG_ID_STATUSTEXT(p_rxmsg);
-		AUDIO_WARNING1();
-		break;
-	case MAVLINK_MSG_ID_SYS_STATUS:
-		REC_MAVLINK_MSG_ID_SYS_STATUS(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
-		REC_MAVLINK_MSG_ID_RC_CHANNELS_RAW(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_RADIO:
-		REC_MAVLINK_MSG_ID_RADIO(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_RADIO_STATUS:
-		REC_MAVLINK_MSG_ID_RADIO_STATUS(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT:
-		REC_MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_VFR_HUD:
-		REC_MAVLINK_MSG_ID_VFR_HUD(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_HIL_CONTROLS:
-		REC_MAVLINK_MSG_ID_HIL_CONTROLS(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_GPS_RAW_INT:
-		REC_MAVLINK_MSG_ID_GPS_RAW_INT(p_rxmsg);
-		break;
+typedef void (*MavlinkMessageHandler)(const mavlink_message_t* msg);
+
+typedef struct {
+	uint8_t msgid;
+	MavlinkMessageHandler handler;
+} MavlinkHandler;
+
+//! \brief The handlers of the decoded messages, the other ones are ignored
+static const MavlinkHandler mavlinkHandlers[] PROGMEM = {
+	{ MAVLINK_MSG_ID_HEARTBEAT, REC_MAVLINK_MSG_ID_HEARTBEAT },
+	{ MAVLINK_MSG_ID_STATUSTEXT, REC_MAVLINK_MSG_ID_STATUSTEXT },
+	{ MAVLINK_MSG_ID_SYS_STATUS, REC_MAVLINK_MSG_ID_SYS_STATUS },
+	{ MAVLINK_MSG_ID_RC_CHANNELS_RAW, REC_MAVLINK_MSG_ID_RC_CHANNELS_RAW },
+	{ MAVLINK_MSG_ID_RADIO, REC_MAVLINK_MSG_ID_RADIO },
+	{ MAVLINK_MSG_ID_RADIO_STATUS, REC_MAVLINK_MSG_ID_RADIO_STATUS },
+	{ MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, REC_MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT },
+	{ MAVLINK_MSG_ID_VFR_HUD, REC_MAVLINK_MSG_ID_VFR_HUD },
+	{ MAVLINK_MSG_ID_HIL_CONTROLS, REC_MAVLINK_MSG_ID_HIL_CONTROLS },
+	{ MAVLINK_MSG_ID_GPS_RAW_INT, REC_MAVLINK_MSG_ID_GPS_RAW_INT },
 #ifdef MAVLINK_PARAMS
-	case MAVLINK_MSG_ID_PARAM_VALUE:
-		REC_MAVLINK_MSG_ID_PARAM_VALUE(p_rxmsg);
-		break;
+	{ MAVLINK_MSG_ID_PARAM_VALUE, REC_MAVLINK_MSG_ID_PARAM_VALUE },
 #endif
-
+};
+
+static inline void handleMessage(const mavlink_message_t* p_rxmsg) {
+	for (uint8_t i = 0; i < DIM(mavlinkHandlers); i++) {
+		if (pgm_read_byte(&mavlinkHandlers[i].msgid) == p_rxmsg->msgid) {
+			MavlinkMessageHandler handler = (MavlinkMessageHandler)pgm_read_adr(&mavlinkHandlers[i].handler);
+			handler(p_rxmsg);
+			return;
+		}
 	}
-
 }
 
+//! The currently decoded message, handed over to its handler once checked
+static mavlink_message_t m_mavlink_message;
 
 /*!	\brief Mavlink message parser
- *	\details Parses the characters in to a mavlink message.
- *	Case statement parses each character as it is recieved.
+ *	\details Parses a run of received characters in to mavlink messages.
+ *	The characters before a start of frame are skipped at once, the payload
+ *	is copied and added to the checksum in one go, only the header and
+ *	checksum characters go through the state machine.
  *	\attention One big change form the 0.9 to 1.0 version is the
  *	MAVLINK_CRC_EXTRA. This requires the mavlink_message_crcs array of 256 bytes.
- *	\todo create dot for the statemachine
  */
-static void MAVLINK_parse_char(uint8_t c) {
+static void MAVLINK_parse(const uint8_t* data, uint8_t len) {
 
-	static mavlink_message_t m_mavlink_message;
-	//! The currently decoded message
-	static mavlink_message_t* p_rxmsg = &m_mavlink_message;
+	mavlink_message_t* p_rxmsg = &m_mavlink_message;
 	//! The current decode status
 	mavlink_status_t* p_status = mavlink_get_channel_status(MAVLINK_COMM_0);
 
-
 #if MAVLINK_CRC_EXTRA
 	static const uint8_t mavlink_message_crcs[256] PROGMEM = MAVLINK_MESSAGE_CRCS;
-#define MAVLINK_MESSAGE_CRC(msgid) mavlink_message_crcs[msgid]
 #endif
 
-	// Initializes only once, values keep unchanged after first initialization
-	//mavlink_parse_state_initialize(p_status);
-
-	//p_status->msg_received = 0;
-
-	switch (p_status->parse_state) {
-	case MAVLINK_PARSE_STATE_UNINIT:
-	case MAVLINK_PARSE_STATE_IDLE:
-		if (c == MAVLINK_STX) {
+	while (len > 0) {
+		if (p_status->parse_state <= MAVLINK_PARSE_STATE_IDLE) {
+			const uint8_t* stx = (const uint8_t*)memchr(data, MAVLINK_STX, len);
+			if (!stx)
+				return;
+			len -= stx + 1 - data;
+			data = stx + 1;
 			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_STX;
 			mavlink_start_checksum(p_rxmsg);
+			continue;
 		}
-		break;
 
-	case MAVLINK_PARSE_STATE_GOT_STX:
-		// NOT counting STX, LENGTH, SEQ, SYSID, COMPID, MSGID, CRC1 and CRC2
-		p_rxmsg->len = c;
-		p_status->packet_idx = 0;
-		mavlink_update_checksum(p_rxmsg, c);
-		p_status->parse_state = MAVLINK_PARSE_STATE_GOT_LENGTH;
-		break;
+		if (p_status->parse_state == MAVLINK_PARSE_STATE_GOT_MSGID) {
+			uint8_t count = p_rxmsg->len - p_status->packet_idx;
+			if (count > len)
+				count = len;
+			memcpy(_MAV_PAYLOAD_NON_CONST(p_rxmsg) + p_status->packet_idx, data, count);
+			crc_accumulate_buffer(&p_rxmsg->checksum, (const char*)data, count);
+			p_status->packet_idx += count;
+			data += count;
+			len -= count;
+			if (p_status->packet_idx == p_rxmsg->len) {
+				p_status->parse_state = MAVLINK_PARSE_STATE_GOT_PAYLOAD;
+			}
+			continue;
+		}
 
-	case MAVLINK_PARSE_STATE_GOT_LENGTH:
-		p_rxmsg->seq = c;
-		mavlink_update_checksum(p_rxmsg, c);
-		p_status->parse_state = MAVLINK_PARSE_STATE_GOT_SEQ;
-		break;
+		uint8_t c = *data++;
+		len--;
 
-	case MAVLINK_PARSE_STATE_GOT_SEQ:
-		p_rxmsg->sysid = c;
-		mavlink_update_checksum(p_rxmsg, c);
-		p_status->parse_state = MAVLINK_PARSE_STATE_GOT_SYSID;
-		break;
+		switch (p_status->parse_state) {
+		case MAVLINK_PARSE_STATE_GOT_STX:
+			// NOT counting STX, LENGTH, SEQ, SYSID, COMPID, MSGID, CRC1 and CRC2
+			p_rxmsg->len = c;
+			p_status->packet_idx = 0;
+			mavlink_update_checksum(p_rxmsg, c);
+			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_LENGTH;
+			break;
 
-	case MAVLINK_PARSE_STATE_GOT_SYSID:
-		p_rxmsg->compid = c;
-		mavlink_update_checksum(p_rxmsg, c);
-		p_status->parse_state = MAVLINK_PARSE_STATE_GOT_COMPID;
-		break;
+		case MAVLINK_PARSE_STATE_GOT_LENGTH:
+			p_rxmsg->seq = c;
+			mavlink_update_checksum(p_rxmsg, c);
+			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_SEQ;
+			break;
 
-	case MAVLINK_PARSE_STATE_GOT_COMPID:
-		p_rxmsg->msgid = c;
-		mavlink_update_checksum(p_rxmsg, c);
-		if (p_rxmsg->len == 0) {
-			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_PAYLOAD;
-		} else {
-			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_MSGID;
-		}
-		break;
+		case MAVLINK_PARSE_STATE_GOT_SEQ:
+			p_rxmsg->sysid = c;
+			mavlink_update_checksum(p_rxmsg, c);
+			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_SYSID;
+			break;
 
-	case MAVLINK_PARSE_STATE_GOT_MSGID:
-		_MAV_PAYLOAD_NON_CONST(p_rxmsg)[p_status->packet_idx++] = (char) c;
-		mavlink_update_checksum(p_rxmsg, c);
-		if (p_status->packet_idx == p_rxmsg->len) {
-			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_PAYLOAD;
-		}
-		break;
+		case MAVLINK_PARSE_STATE_GOT_SYSID:
+			p_rxmsg->compid = c;
+			mavlink_update_checksum(p_rxmsg, c);
+			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_COMPID;
+			break;
 
-	case MAVLINK_PARSE_STATE_GOT_PAYLOAD:
+		case MAVLINK_PARSE_STATE_GOT_COMPID:
+			p_rxmsg->msgid = c;
+			mavlink_update_checksum(p_rxmsg, c);
+			if (p_rxmsg->len == 0) {
+				p_status->parse_state = MAVLINK_PARSE_STATE_GOT_PAYLOAD;
+			} else {
+				p_status->parse_state = MAVLINK_PARSE_STATE_GOT_MSGID;
+			}
+			break;
 
+		case MAVLINK_PARSE_STATE_GOT_PAYLOAD:
 #if MAVLINK_CRC_EXTRA
-		mavlink_update_checksum(p_rxmsg, pgm_read_byte(&(mavlink_message_crcs[p_rxmsg->msgid])));
+			mavlink_update_checksum(p_rxmsg, pgm_read_byte(&(mavlink_message_crcs[p_rxmsg->msgid])));
 #endif
-		if (c != (p_rxmsg->checksum & 0xFF)) {
-			// Check first checksum byte
-			p_status->parse_error = 3;
-		} else {
-			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_CRC1;
+			if (c != (p_rxmsg->checksum & 0xFF)) {
+				// Check first checksum byte
+				p_status->parse_error = 3;
+			} else {
+				p_status->parse_state = MAVLINK_PARSE_STATE_GOT_CRC1;
+			}
+			break;
+
+		case MAVLINK_PARSE_STATE_GOT_CRC1:
+			if (c != (p_rxmsg->checksum >> 8)) {
+				// Check second checksum byte
+				p_status->parse_error = 4;
+			} else {
+				// Successfully got message
+				if (mav_heartbeat < 0)
+					mav_heartbeat = 0;
+				p_status->current_rx_seq = p_rxmsg->seq;
+				p_status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+				handleMessage(p_rxmsg);
+			}
+			break;
 		}
-		break;
 
-	case MAVLINK_PARSE_STATE_GOT_CRC1:
-		if (c != (p_rxmsg->checksum >> 8)) {
-			// Check second checksum byte
-			p_status->parse_error = 4;
-		} else {
-			// Successfully got message
-			if (mav_heartbeat < 0)
-				mav_heartbeat = 0;
-			p_status->current_rx_seq = p_rxmsg->seq;
-			//p_status->msg_received = 1;
+		// Error occur
+		if (p_status->parse_error) {
 			p_status->parse_state = MAVLINK_PARSE_STATE_IDLE;
-			//memcpy(r_message, p_rxmsg, sizeof(mavlink_message_t));
-			handleMessage(p_rxmsg);
-		}
-		break;
-	}
-	// Error occur
-	if (p_status->parse_error) {
-		p_status->parse_state = MAVLINK_PARSE_STATE_IDLE;
-		if (c == MAVLINK_STX) {
-			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_STX;
-			mavlink_start_checksum(p_rxmsg);
+			if (c == MAVLINK_STX) {
+				p_status->parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+				mavlink_start_checksum(p_rxmsg);
+			}
+			p_status->parse_error = 0;
 		}
-		p_status->parse_error = 0;
-
 	}
-	// If a message has been sucessfully decoded, check index
-	/*
-	 if (p_status->msg_received == 1) {
-	 p_status->current_rx_seq = p_rxmsg->seq;
-	 p_status->packet_rx_success_count++;
-	 }
-	 */
-
-	//r_mavlink_status->current_rx_seq = p_status->current_rx_seq + 1;
-	//r_mavlink_status->packet_rx_success_count = p_status->packet_rx_success_count;
-	//r_mavlink_status->packet_rx_drop_count = p_status->parse_error;
-	//p_status->parse_error = 0;
-	//return p_status->msg_received;
 }
 
 #ifdef MAVLINK_PARAMS
@@ -717,6 +719,25 @@ static inline void MAVLINK_msg_set_mode_send(uint8_t mode) {
  *
  */
 void telemetryWakeup() {
+	uint8_t overflows = mavlinkRxOverflows;
+	if (overflows != mavlinkRxOverflowsSeen) {
+		// bytes were dropped: the fifo content doesn't follow the message being
+		// parsed any more, it is flushed and the parser waits for the next STX
+		mavlinkRxOverflowsSeen = overflows;
+		mavlinkRxRidx = mavlinkRxWidx;
+		mavlink_get_channel_status(MAVLINK_COMM_0)->parse_state = MAVLINK_PARSE_STATE_IDLE;
+	}
+
+	// the received characters are parsed in at most two runs, before and after the end of the fifo
+	uint8_t widx = mavlinkRxWidx;
+	uint8_t ridx = mavlinkRxRidx;
+	if (widx < ridx) {
+		MAVLINK_parse(&mavlinkRxFifo[ridx], MAVLINK_RX_FIFO_SIZE - ridx);
+		ridx = 0;
+	}
+	MAVLINK_parse(&mavlinkRxFifo[ridx], widx - ridx);
+	mavlinkRxRidx = widx;
+
 	uint16_t tmr10ms = get_tmr10ms();
 	uint8_t count = tmr10ms & 0x0f; // 15*10ms
 	if (!count) {
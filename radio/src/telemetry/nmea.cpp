@@ -52,6 +52,9 @@ uint8_t xpack[NB_LONG_BUF+NB_SHORT_BUF];	// expected packet
 uint8_t ibuf[NB_LONG_BUF];					// subscripts on long buffers values
 char rbuf[NB_LONG_BUF][LG_BUF];				// long receive buffers
 char sbuf[NB_SHORT_BUF];					// short receive buffers
+char pbuf[NB_LONG_BUF][LG_BUF];				// long values of the packet being received
+char psbuf[NB_SHORT_BUF];					// short values of the packet being received
+uint8_t rsum, xsum;							// received and expected packet checksums
 const char val_unknown[] = "?";
 int32_t home_alt, save_alt, rel_alt, prev_alt, lift_alt, max_alt, abs_alt;	// integer values for altitude computations
 int32_t gpstimer=0;
@@ -157,6 +160,7 @@ $GPRMC - Recommended Minimum Navigation Information
 
 // end of packet
 #define PACK_END 0x2a			//  *
+#define PACK_START 0x24			//  $
 // end of value
 #define VAL_END 0x2c			//  ,
 
@@ -174,6 +178,8 @@ $GPRMC - Recommended Minimum Navigation Information
 #define WAIT_PACK_RMC3  6
 #define WAIT_VAL_END	7
 #define READ_VALUE      8
+#define READ_CHECKSUM1  9
+#define READ_CHECKSUM2  10
 
 void menuTelemetryNMEA1(uint8_t event);
 void menuTelemetryNMEA2(uint8_t event);
@@ -225,6 +231,27 @@ ISR (USART0_RX_vect)
         RXB80:	Rx data bit 8
         TXB80:	Tx data bit 8
 */
+    NMEA_parse (rl);
+}
+#endif
+
+static uint8_t hexval (uint8_t c)
+{
+    return (c <= '9') ? c - '0' : (c & 0x0f) + 9;
+}
+
+// The values are written in pbuf / psbuf, then copied in rbuf / sbuf when the packet checksum is right
+void NMEA_parse (uint8_t rl)
+{
+    if (rl == PACK_START)
+    {
+        rsum = 0;							// a new packet starts, whatever the current state
+        state = WAIT_PACKET;
+        return;
+    }
+    if (state < READ_CHECKSUM1 && rl != PACK_END)
+        rsum ^= rl;							// XOR of all chars between $ and *
+
     switch (state)
     {
     case WAIT_PACKET:
@@ -284,6 +311,8 @@ ISR (USART0_RX_vect)
             rval = 1;
             for (i = 0; i < NB_LONG_BUF; i++)	// clear buffer
                 ibuf[i] = 0;
+            for (i = 0; i < NB_SHORT_BUF; i++)	// unchanged if not received
+                psbuf[i] = sbuf[i];
         }
         else
             state = WAIT_PACKET;		// restart if not found
@@ -294,9 +323,7 @@ ISR (USART0_RX_vect)
         switch (rl)
         {
         case PACK_END:
-            if (rpack == PACK_GGA)
-                ggareceived = 1;
-            state = WAIT_PACKET;		// packet completed, wait for the next packet
+            state = READ_CHECKSUM1;		// packet completed, check it
             break;
         case VAL_END:					// comma found, value completed
             rval++;						// and get next value
@@ -306,21 +333,41 @@ ISR (USART0_RX_vect)
             {							// is it the expected value in the expected packet ?
                 if (rpack == xpack[i] && rval == xval[i] && ibuf[i] < LG_BUF - 1)
                 {						// yes, store the char
-                    rbuf[i] [ibuf[i]] = rl;
+                    pbuf[i] [ibuf[i]] = rl;
                     ibuf[i]++;
-                    rbuf[i] [ibuf[i]] = 0;
+                    pbuf[i] [ibuf[i]] = 0;
                 }
             }
             for (i = NB_LONG_BUF; i < NB_LONG_BUF+NB_SHORT_BUF; i++) {
                 if (rpack == xpack[i]   // is this the expected short value in the expected packet ?
                         &&  rval == xval[i])
-                    sbuf[i-NB_LONG_BUF] = rl;      // yes, store the char
+                    psbuf[i-NB_LONG_BUF] = rl;      // yes, store the char
             }
         }
         break;
+
+    case READ_CHECKSUM1:
+        xsum = hexval(rl) << 4;
+        state = READ_CHECKSUM2;
+        break;
+
+    case READ_CHECKSUM2:
+        if ((xsum | hexval(rl)) == rsum)
+        {
+            for (i = 0; i < NB_LONG_BUF; i++)
+            {
+                if (ibuf[i])			// values not received are kept
+                    memcpy(rbuf[i], pbuf[i], ibuf[i]+1);
+            }
+            for (i = 0; i < NB_SHORT_BUF; i++)
+                sbuf[i] = psbuf[i];
+            if (rpack == PACK_GGA)
+                ggareceived = 1;
+        }
+        state = WAIT_PACKET;			// wait for the next packet
+        break;
     }
 }
-#endif
 
 void NMEA_Init (void)
 {
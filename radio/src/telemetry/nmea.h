@@ -39,6 +39,7 @@
 
 void NMEA_Init(void);
 void NMEA_EnableRXD (void);
+void NMEA_parse (uint8_t rl);
 void menuTelemetryNMEA(uint8_t event);
 
 #endif
@@ -3,6 +3,34 @@
 TelemetryItem telemetryItems[MAX_SENSORS];
 uint8_t allowNewSensors;
 
+#if MAX_SENSORS > 32
+  #error "telemetryItemsUpdated has one bit per sensor"
+#endif
+
+// one bit per sensor which changed since the calculated sensors were evaluated, set
+// by the mixer task (telemetryWakeup) and by the menus task (telemetryReset): all the
+// read modify write accesses are done with the interrupts (and the task switches) disabled
+uint32_t telemetryItemsUpdated = 0;
+
+// the calculated sensors, their evaluation order (their inputs first) and the ones read before they are evaluated (loops)
+CalculatedSensor calculatedSensors[MAX_SENSORS];
+uint8_t calculatedSensorsOrder[MAX_SENSORS];
+uint8_t calculatedSensorsCount = 0;
+uint32_t calculatedSensorsFeedback = 0;
+bool calculatedSensorsValid = false;
+
+#define SENSOR_BIT(index)  ((uint32_t)1 << (index))
+
+void TelemetryItem::updated()
+{
+  unsigned int index = this - telemetryItems;
+  if (index < MAX_SENSORS) {
+    __disable_irq();
+    telemetryItemsUpdated |= SENSOR_BIT(index);
+    __enable_irq();
+  }
+}
+
 void TelemetryItem::gpsReceived()
 {
   if (!distFromEarthAxis) {
@@ -13,12 +41,16 @@ void TelemetryItem::gpsReceived()
     distFromEarthAxis = 139*(((uint32_t)10000000-((angle2*(uint32_t)123370)/81)+(angle4/25))/12500);
   }
   lastReceived = now();
+  updated();
 }
 
 void TelemetryItem::setValue(const TelemetrySensor & sensor, int32_t val, uint32_t unit, uint32_t prec)
 {
   int32_t newVal = val;
 
+  // even a partial value (cells, GPS) may be read by a calculated sensor
+  updated();
+
   if (unit == UNIT_CELLS) {
     uint32_t data = uint32_t(newVal);
     uint8_t cellsCount = (data >> 24);
@@ -287,7 +319,7 @@ void TelemetryItem::per10ms(const TelemetrySensor & sensor)
   }
 }
 
-void TelemetryItem::eval(const TelemetrySensor & sensor)
+void TelemetryItem::eval(const TelemetrySensor & sensor, const CalculatedSensor & calculated)
 {
   switch (sensor.formula) {
     case TELEM_FORMULA_CELL:
@@ -382,7 +414,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
     case TELEM_FORMULA_MAX:
     case TELEM_FORMULA_MULTIPLY:
     {
-      int32_t value=0, count=0, available=0, maxitems=4, mulprec=0;
+      int32_t value=0, count=0, available=0, maxitems=4;
       if (sensor.formula == TELEM_FORMULA_MULTIPLY) {
         maxitems = 2;
         value = 1;
@@ -391,7 +423,6 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
         int8_t source = sensor.calc.sources[i];
         if (source) {
           unsigned int index = abs(source)-1;
-          TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
           TelemetryItem & telemetryItem = telemetryItems[index];
           if (sensor.formula == TELEM_FORMULA_AVERAGE) {
             if (telemetryItem.isAvailable())
@@ -415,11 +446,10 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
             sensorValue = -sensorValue;
           count += 1;
           if (sensor.formula == TELEM_FORMULA_MULTIPLY) {
-            mulprec += telemetrySensor.prec;
-            value *= convertTelemetryValue(sensorValue, telemetrySensor.unit, 0, sensor.unit, 0);
+            value *= calculated.sources[i].apply(sensorValue);
           }
           else {
-            sensorValue = convertTelemetryValue(sensorValue, telemetrySensor.unit, telemetrySensor.prec, sensor.unit, sensor.prec);
+            sensorValue = calculated.sources[i].apply(sensorValue);
             if (sensor.formula == TELEM_FORMULA_MIN)
               value = (count==1 ? sensorValue : min<int32_t>(value, sensorValue));
             else if (sensor.formula == TELEM_FORMULA_MAX)
@@ -442,7 +472,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
       else if (sensor.formula == TELEM_FORMULA_MULTIPLY) {
         if (count == 0)
           return;
-        value = convertTelemetryValue(value, sensor.unit, mulprec, sensor.unit, sensor.prec);
+        value = calculated.result.apply(value);
       }
       setValue(sensor, value, sensor.unit, sensor.prec);
       break;
@@ -453,6 +483,146 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
   }
 }
 
+void compileCalculatedSensor(const TelemetrySensor & sensor, CalculatedSensor & calculated)
+{
+  memclear(&calculated, sizeof(calculated));
+
+  switch (sensor.formula) {
+    case TELEM_FORMULA_CELL:
+      if (sensor.cell.source) {
+        calculated.inputs = SENSOR_BIT(sensor.cell.source-1);
+      }
+      break;
+
+    case TELEM_FORMULA_DIST:
+      if (sensor.dist.gps) {
+        calculated.inputs |= SENSOR_BIT(sensor.dist.gps-1);
+      }
+      if (sensor.dist.alt) {
+        calculated.inputs |= SENSOR_BIT(sensor.dist.alt-1);
+      }
+      break;
+
+    default:
+    {
+      uint8_t maxitems=4, mulprec=0;
+      if (sensor.formula == TELEM_FORMULA_MULTIPLY) {
+        maxitems = 2;
+      }
+      for (int i=0; i<maxitems; i++) {
+        int8_t source = sensor.calc.sources[i];
+        if (source) {
+          unsigned int index = abs(source)-1;
+          const TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
+          calculated.inputs |= SENSOR_BIT(index);
+          if (sensor.formula == TELEM_FORMULA_MULTIPLY) {
+            mulprec += telemetrySensor.prec;
+            calculated.sources[i].init(telemetrySensor.unit, 0, sensor.unit, 0);
+          }
+          else {
+            calculated.sources[i].init(telemetrySensor.unit, telemetrySensor.prec, sensor.unit, sensor.prec);
+          }
+        }
+      }
+      calculated.result.init(sensor.unit, mulprec, sensor.unit, sensor.prec);
+      break;
+    }
+  }
+}
+
+void compileCalculatedSensors()
+{
+  uint32_t pending = 0;
+
+  for (int index=0; index<MAX_SENSORS; index++) {
+    const TelemetrySensor & sensor = g_model.telemetrySensors[index];
+    if (sensor.type == TELEM_TYPE_CALCULATED && sensor.formula != TELEM_FORMULA_TOTALIZE && sensor.formula != TELEM_FORMULA_CONSUMPTION) {
+      CalculatedSensor & calculated = calculatedSensors[index];
+      compileCalculatedSensor(sensor, calculated);
+      if (!calculated.inputs) {
+        // no inputs, it only depends on itself: evaluated once after the
+        // compilation, then again only when its own value changed
+        calculated.inputs = SENSOR_BIT(index);
+      }
+      pending |= SENSOR_BIT(index);
+    }
+  }
+
+  uint32_t sensors = pending;
+  calculatedSensorsCount = 0;
+  while (pending) {
+    int next = -1;
+    for (int index=0; index<MAX_SENSORS; index++) {
+      if ((pending & SENSOR_BIT(index)) && !(calculatedSensors[index].inputs & pending & ~SENSOR_BIT(index))) {
+        next = index;
+        break;
+      }
+    }
+    if (next < 0) {
+      // a loop between calculated sensors, it is broken at its first sensor
+      for (next=0; !(pending & SENSOR_BIT(next)); next++);
+    }
+    calculatedSensorsOrder[calculatedSensorsCount++] = next;
+    pending &= ~SENSOR_BIT(next);
+  }
+
+  uint32_t evaluated = 0;
+  calculatedSensorsFeedback = 0;
+  for (int i=0; i<calculatedSensorsCount; i++) {
+    uint8_t index = calculatedSensorsOrder[i];
+    calculatedSensorsFeedback |= calculatedSensors[index].inputs & sensors & ~evaluated;
+    evaluated |= SENSOR_BIT(index);
+  }
+
+  // everything is evaluated once after a change
+  __disable_irq();
+  telemetryItemsUpdated |= sensors;
+  __enable_irq();
+  calculatedSensorsValid = true;
+}
+
+void invalidateCalculatedSensors()
+{
+  calculatedSensorsValid = false;
+}
+
+void evalCalculatedSensors()
+{
+  if (!calculatedSensorsValid) {
+    compileCalculatedSensors();
+  }
+
+  // the values set during this pass are seen by the next sensors in the order
+  __disable_irq();
+  uint32_t updated = telemetryItemsUpdated;
+  telemetryItemsUpdated = 0;
+  __enable_irq();
+
+  uint32_t evaluated = 0;
+
+  for (int i=0; i<calculatedSensorsCount; i++) {
+    uint8_t index = calculatedSensorsOrder[i];
+    const CalculatedSensor & calculated = calculatedSensors[index];
+    if (calculated.inputs & (updated | telemetryItemsUpdated)) {
+      TelemetryItem & item = telemetryItems[index];
+      uint8_t lastReceived = item.lastReceived;
+      evaluated |= SENSOR_BIT(index);
+      item.eval(g_model.telemetrySensors[index], calculated);
+      if (item.lastReceived != lastReceived) {
+        item.updated();
+      }
+    }
+  }
+
+  // of the sensors evaluated in this pass, only the ones read before they changed
+  // are kept for the next pass; the bits the menus task set meanwhile for the other
+  // sensors are kept too (a reset also invalidates the calculated sensors, which
+  // are then all evaluated again)
+  __disable_irq();
+  telemetryItemsUpdated &= calculatedSensorsFeedback | ~evaluated;
+  __enable_irq();
+}
+
 void delTelemetryIndex(uint8_t index)
 {
   memclear(&g_model.telemetrySensors[index], sizeof(TelemetrySensor));
@@ -575,32 +745,37 @@ const UnitConversionRule unitConversionTable[] = {
   { 0, 0, 0, 0}   // termination
 };
 
-int32_t convertTelemetryValue(int32_t value, uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec)
+void TelemetryConversion::init(uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec)
 {
+  multiplier = 1;
+  divisor = 1;
+  fahrenheit = (unit == UNIT_CELSIUS && destUnit == UNIT_FAHRENHEIT);
+
   for (int i=prec; i<destPrec; i++)
-    value *= 10;
+    multiplier *= 10;
 
-  if (unit == UNIT_CELSIUS) {
-    if (destUnit == UNIT_FAHRENHEIT) {
-      // T(°F) = T(°C)×1,8 + 32
-      value = 32 + (value*18) / 10;
-    }
-  }
-  else {
+  if (unit != UNIT_CELSIUS) {
     const UnitConversionRule * p = unitConversionTable;
     while (p->divisor) {
       if (p->unitFrom == unit && p->unitTo == destUnit) {
-        value = (value * (int32_t)p->multiplier) / (int32_t)p->divisor;
+        multiplier *= p->multiplier;
+        divisor = p->divisor;
         break;
       }
       ++p;
     }
   }
-  
+
+  // successive truncated divisions give the same result as a single one
   for (int i=destPrec; i<prec; i++)
-    value /= 10;
+    divisor *= 10;
+}
 
-  return value;
+int32_t convertTelemetryValue(int32_t value, uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec)
+{
+  TelemetryConversion conversion;
+  conversion.init(unit, prec, destUnit, destPrec);
+  return conversion.apply(value);
 }
 
 int32_t TelemetrySensor::getValue(int32_t value, uint8_t unit, uint8_t prec) const
@@ -62,6 +62,33 @@ enum {
   TELEM_CELL_INDEX_DELTA,
 };
 
+// Unit and precision conversion of a telemetry value, computed once when the sensors are configured
+struct TelemetryConversion
+{
+  int32_t multiplier;
+  int32_t divisor;
+  bool fahrenheit;
+
+  void init(uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec);
+
+  int32_t apply(int32_t value) const
+  {
+    if (fahrenheit) {
+      // T(F) = T(C)*1.8 + 32
+      return (32 + (value * multiplier * 18) / 10) / divisor;
+    }
+    return (value * multiplier) / divisor;
+  }
+};
+
+// A calculated sensor, with the sensors it reads and the conversions of their values
+struct CalculatedSensor
+{
+  uint32_t inputs;
+  TelemetryConversion sources[4];
+  TelemetryConversion result;
+};
+
 PACK(struct CellValue
 {
   uint16_t value:15;
@@ -154,7 +181,7 @@ class TelemetryItem
       lastReceived = TELEMETRY_VALUE_UNAVAILABLE;
     }
 
-    void eval(const TelemetrySensor & sensor);
+    void eval(const TelemetrySensor & sensor, const CalculatedSensor & calculated);
     void per10ms(const TelemetrySensor & sensor);
 
     void setValue(const TelemetrySensor & sensor, int32_t newVal, uint32_t unit, uint32_t prec=0);
@@ -162,9 +189,11 @@ class TelemetryItem
     bool isFresh();
     bool isOld();
     void gpsReceived();
+    void updated();
 };
 
 extern TelemetryItem telemetryItems[MAX_SENSORS];
+extern uint32_t telemetryItemsUpdated;
 extern uint8_t allowNewSensors;
 
 inline bool isTelemetryFieldAvailable(int index)
@@ -189,6 +218,8 @@ int availableTelemetryIndex();
 int lastUsedTelemetryIndex();
 int32_t getTelemetryValue(uint8_t index, uint8_t & prec);
 int32_t convertTelemetryValue(int32_t value, uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec);
+void invalidateCalculatedSensors();
+void evalCalculatedSensors();
 
 void frskySportSetDefault(int index, uint16_t id, uint8_t subId, uint8_t instance);
 void frskyDSetDefault(int index, uint16_t id);
@@ -0,0 +1,67 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "gtests.h"
+#include "bin_allocator.h"
+
+TEST(BinAllocator, mallocAndFree)
+{
+  BinAllocator<16, 4> slots;
+  void * bins[4];
+
+  EXPECT_EQ(0, (intptr_t)slots.malloc(17));
+  for (int i=0; i<4; i++) {
+    bins[i] = slots.malloc(16);
+    EXPECT_NE(0, (intptr_t)bins[i]);
+    EXPECT_TRUE(slots.is_member(bins[i]));
+  }
+  EXPECT_EQ(0, (intptr_t)slots.malloc(8));
+  EXPECT_EQ(1, slots.overflows());
+  EXPECT_EQ(4, slots.size());
+
+  int outside;
+  EXPECT_FALSE(slots.free(&outside));
+  EXPECT_TRUE(slots.free(bins[2]));
+  EXPECT_TRUE(slots.free(bins[0]));
+  EXPECT_EQ(2, slots.size());
+  EXPECT_EQ(4, slots.peak());
+
+  // the last freed slot is given back first
+  EXPECT_EQ(bins[0], slots.malloc(1));
+  EXPECT_EQ(bins[2], slots.malloc(1));
+  EXPECT_EQ(0, (intptr_t)slots.malloc(1));
+  EXPECT_EQ(2, slots.overflows());
+}
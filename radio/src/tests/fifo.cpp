@@ -0,0 +1,134 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "gtests.h"
+
+#if defined(CPUARM)
+TEST(Fifo, bulkReadWrapsAround)
+{
+  Fifo<8> fifo;
+  uint8_t buffer[8];
+  uint8_t * data;
+
+  for (int i=0; i<6; i++) {
+    fifo.push(i);
+  }
+  EXPECT_EQ(4, fifo.pop(buffer, 4));
+  EXPECT_EQ(3, buffer[3]);
+
+  for (int i=6; i<11; i++) {
+    fifo.push(i);
+  }
+  EXPECT_EQ(7, fifo.size());
+
+  // the first span stops at the end of the buffer
+  EXPECT_EQ(4, fifo.readSpan(data));
+  EXPECT_EQ(4, data[0]);
+  fifo.skip(4);
+  EXPECT_EQ(3, fifo.readSpan(data));
+  EXPECT_EQ(8, data[0]);
+
+  EXPECT_EQ(3, fifo.pop(buffer, sizeof(buffer)));
+  EXPECT_EQ(10, buffer[2]);
+  EXPECT_TRUE(fifo.isEmpty());
+  EXPECT_EQ(0, fifo.readSpan(data));
+}
+
+TEST(Fifo, bulkWriteWrapsAround)
+{
+  Fifo<8> fifo;
+  uint8_t data[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  uint8_t buffer[8];
+
+  EXPECT_EQ(5, fifo.push(data, 5));
+  EXPECT_EQ(3, fifo.pop(buffer, 3));
+
+  // 7 bytes fit, 3 of them after the wrap
+  EXPECT_EQ(5, fifo.push(&data[5], 5));
+  EXPECT_EQ(7, fifo.size());
+  EXPECT_EQ(0, fifo.push(data, 1));
+
+  EXPECT_EQ(7, fifo.pop(buffer, sizeof(buffer)));
+  for (int i=0; i<7; i++) {
+    EXPECT_EQ(i+3, buffer[i]);
+  }
+}
+
+TEST(Fifo, dmaWriteIndex)
+{
+  Fifo<8> fifo;
+  uint8_t * data;
+
+  // a circular DMA writes 10 bytes, 2 of them after the wrap
+  for (int i=0; i<10; i++) {
+    fifo.buffer()[i & 7] = i;
+  }
+  fifo.setWriteIndex(8 - 6);
+  fifo.skip(4);
+  EXPECT_EQ(6, fifo.size());
+  EXPECT_EQ(4, fifo.readSpan(data));
+  EXPECT_EQ(4, data[0]);
+  fifo.skip(4);
+  EXPECT_EQ(2, fifo.readSpan(data));
+  EXPECT_EQ(8, data[0]);
+}
+
+TEST(Fifo, dmaOverrun)
+{
+  Fifo<8> fifo;
+  uint8_t * data;
+
+  fifo.setWriteIndex(5);
+  EXPECT_EQ(5, fifo.size());
+  // 3 more bytes, the buffer would look empty
+  fifo.setWriteIndex(8);
+  EXPECT_TRUE(fifo.checkOverrun());
+  EXPECT_EQ(0, fifo.size());
+  EXPECT_FALSE(fifo.checkOverrun());
+
+  // the next bytes are read normally
+  fifo.setWriteIndex(3);
+  EXPECT_EQ(3, fifo.readSpan(data));
+  fifo.skip(3);
+
+  // the consumer drops the unread bytes after an error
+  fifo.setWriteIndex(6);
+  fifo.setOverrun();
+  EXPECT_EQ(2, fifo.getOverruns());
+  EXPECT_EQ(0, fifo.readSpan(data));
+  EXPECT_TRUE(fifo.isEmpty());
+}
+#endif
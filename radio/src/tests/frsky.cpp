@@ -189,6 +189,51 @@ TEST(FrSky, HubAltNegative)
   processHubPacket(BARO_ALT_AP_ID, 05);
   EXPECT_EQ(telemetryItems[0].value, 120); 
 }
+
+TEST(Telemetry, convertTelemetryValue)
+{
+  EXPECT_EQ(convertTelemetryValue(25, UNIT_CELSIUS, 0, UNIT_FAHRENHEIT, 0), 77);
+  EXPECT_EQ(convertTelemetryValue(-40, UNIT_CELSIUS, 0, UNIT_FAHRENHEIT, 0), -40);
+  EXPECT_EQ(convertTelemetryValue(1000, UNIT_KMH, 1, UNIT_METERS_PER_SECOND, 2), 2777);
+  EXPECT_EQ(convertTelemetryValue(12345, UNIT_METERS, 2, UNIT_FEET, 0), 405);
+  EXPECT_EQ(convertTelemetryValue(-1239, UNIT_VOLTS, 2, UNIT_VOLTS, 1), -123);
+}
+
+TEST(Telemetry, CalculatedSensorsChain)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+
+  // sensor 1 is computed from sensor 2, then sensor 0 from sensor 1
+  TelemetrySensor * sensors = g_model.telemetrySensors;
+  sensors[2].type = TELEM_TYPE_CUSTOM;
+  sensors[2].init("Bat", UNIT_VOLTS, 2);
+  sensors[1].type = TELEM_TYPE_CALCULATED;
+  sensors[1].formula = TELEM_FORMULA_ADD;
+  sensors[1].init("Sum", UNIT_VOLTS, 1);
+  sensors[1].calc.sources[0] = 3;
+  sensors[0].type = TELEM_TYPE_CALCULATED;
+  sensors[0].formula = TELEM_FORMULA_MULTIPLY;
+  sensors[0].init("Pow", UNIT_VOLTS, 1);
+  sensors[0].calc.sources[0] = 2;
+  sensors[0].calc.sources[1] = 2;
+  invalidateCalculatedSensors();
+
+  telemetryItems[2].setValue(sensors[2], 1234, UNIT_VOLTS, 2);
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[1].value, 123);
+  EXPECT_EQ(telemetryItems[0].value, 1512);
+
+  telemetryItems[2].setValue(sensors[2], 500, UNIT_VOLTS, 2);
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[1].value, 50);
+  EXPECT_EQ(telemetryItems[0].value, 250);
+
+  // nothing new, nothing evaluated
+  telemetryItems[1].value = 0;
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[1].value, 0);
+}
 #endif  // #if defined(FRSKY) && defined(CPUARM)
 
 #if defined(FRSKY_SPORT)
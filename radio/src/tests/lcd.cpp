@@ -130,6 +130,28 @@ TEST(outdezNAtt, testBigNumbers)
 #endif // #if defined(CPUARM)
 
 
+TEST(Lcd, refreshDamage)
+{
+  int firstRow, lastRow;
+
+  lcd_clear();
+  lcdRefresh();
+  lcdGetDamage(firstRow, lastRow);
+
+  lcdRefresh();
+  EXPECT_FALSE(lcdGetDamage(firstRow, lastRow));
+
+  lcd_hline(0, 20, 10);
+  lcd_hline(0, 30, 10);
+  lcdRefresh();
+  EXPECT_TRUE(lcdGetDamage(firstRow, lastRow));
+  EXPECT_LE(firstRow, 20);
+  EXPECT_GE(lastRow, 30);
+  EXPECT_GT(firstRow, 10);
+  EXPECT_LT(lastRow, 40);
+  EXPECT_FALSE(lcdGetDamage(firstRow, lastRow));
+}
+
 TEST(Lcd, Invers_0_0)
 {
   lcd_clear();
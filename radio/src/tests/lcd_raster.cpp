@@ -0,0 +1,270 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include "gtests.h"
+
+#if defined(PCBTARANIS)
+// The raster primitives write whole bytes and words, they must give exactly the same pixels
+// as the former implementations, which are kept here and drawn with lcd_plot / lcd_mask
+static void refHlineStip(coord_t x, coord_t y, coord_t w, uint8_t pat, LcdFlags att)
+{
+  if (w < 0) { x += w; w = -w; }
+  if (y < 0 || y >= LCD_H) return;
+  if (x+w > LCD_W) {
+    if (x >= LCD_W ) return;
+    w = LCD_W - x;
+  }
+  while (w--) {
+    if (pat&1) {
+      lcd_plot(x, y, att);
+      pat = (pat >> 1) | 0x80;
+    }
+    else {
+      pat = pat >> 1;
+    }
+    x++;
+  }
+}
+
+static void refVlineStip(coord_t x, scoord_t y, scoord_t h, uint8_t pat, LcdFlags att)
+{
+  if (x >= LCD_W) return;
+  if (y >= LCD_H) return;
+  if (h<0) { y+=h; h=-h; }
+  if (y<0) { h+=y; y=0; if (h<=0) return; }
+  if (y+h > LCD_H) { h = LCD_H - y; }
+  if (pat==DOTTED && !(y%2)) {
+    pat = ~pat;
+  }
+  while (h--) {
+    if (pat & 1) {
+      lcd_plot(x, y, att);
+      pat = (pat >> 1) | 0x80;
+    }
+    else {
+      pat = pat >> 1;
+    }
+    y++;
+  }
+}
+
+static void refLine(coord_t x1, coord_t y1, coord_t x2, coord_t y2, uint8_t pat, LcdFlags att)
+{
+  if (x1<0 || x1>=LCD_W || y1<0 || y1>=LCD_H || x2<0 || x2>=LCD_W || y2<0 || y2>=LCD_H) return;
+  int dx = x2-x1, dy = y2-y1;
+  int dxabs = abs(dx), dyabs = abs(dy);
+  int sdx = sgn(dx), sdy = sgn(dy);
+  int x = dyabs>>1, y = dxabs>>1;
+  int px = x1, py = y1;
+  if (dxabs >= dyabs) {
+    for (int i=0; i<=dxabs; i++) {
+      if ((1<<(px%8)) & pat) lcd_plot(px, py, att);
+      y += dyabs;
+      if (y>=dxabs) { y -= dxabs; py += sdy; }
+      px += sdx;
+    }
+  }
+  else {
+    for (int i=0; i<=dyabs; i++) {
+      if ((1<<(py%8)) & pat) lcd_plot(px, py, att);
+      x += dxabs;
+      if (x >= dyabs) { x -= dyabs; px += sdx; }
+      py += sdy;
+    }
+  }
+}
+
+static void refFilledRect(coord_t x, scoord_t y, coord_t w, coord_t h, uint8_t pat, LcdFlags att)
+{
+  for (scoord_t i=y; i<y+h; i++) {
+    if ((att&ROUND) && (i==y || i==y+h-1))
+      refHlineStip(x+1, i, w-2, pat, att);
+    else
+      refHlineStip(x, i, w, pat, att);
+    pat = (pat >> 1) + ((pat & 1) << 7);
+  }
+}
+
+static void refImg(coord_t x, coord_t y, const pm_uchar * img, uint8_t idx, LcdFlags att)
+{
+  const pm_uchar *q = img;
+  uint8_t w    = pgm_read_byte(q++);
+  uint8_t hb   = (pgm_read_byte(q++)+7) / 8;
+  bool    inv  = (att & INVERS);
+  q += idx*w*hb;
+  for (uint8_t yb = 0; yb < hb; yb++) {
+    for (coord_t i=0; i<w; i++) {
+      uint8_t b = pgm_read_byte(q++);
+      uint8_t val = inv ? ~b : b;
+      for (int k=0; k<8; k++) {
+        if (val & (1<<k)) {
+          lcd_plot(x+i, y+yb*8+k, 0);
+        }
+      }
+    }
+  }
+}
+
+static const pm_uchar refImage[] PROGMEM = {
+  10, 12,
+  0x81, 0x42, 0x24, 0x18, 0xff, 0x00, 0x3c, 0x7e, 0x01, 0x80,
+  0x0f, 0x00, 0x05, 0x0a, 0x0f, 0x03, 0x0c, 0x09, 0x06, 0x0f,
+};
+
+static const LcdFlags refAttributes[] = {
+  0, FORCE, ERASE, FILL_WHITE, FORCE|FILL_WHITE, ROUND, ERASE|ROUND,
+  GREY(5), FORCE|GREY(7), ERASE|GREY(3), GREY_DEFAULT|ROUND,
+};
+
+static uint8_t refPattern(int r)
+{
+  static const uint8_t patterns[] = { SOLID, DOTTED, 0xAA, 0x0F, 0x01, 0x81 };
+  return patterns[r % DIM(patterns)];
+}
+
+struct RasterOperation {
+  int kind;
+  LcdFlags att;
+  uint8_t pat;
+  coord_t x, x2, y2;
+  scoord_t y, h;
+  coord_t w;
+  uint8_t idx;
+};
+
+static void drawRasterOperation(const RasterOperation & op, bool reference)
+{
+  switch (op.kind) {
+    case 0:
+      (reference ? refHlineStip : lcd_hlineStip)(op.x, op.y, op.w, op.pat, op.att);
+      break;
+    case 1:
+      (reference ? refVlineStip : lcd_vlineStip)(op.x, op.y, op.h, op.pat, op.att);
+      break;
+    case 2:
+      (reference ? refFilledRect : drawFilledRect)(op.x, op.y, op.w, op.h, op.pat, op.att);
+      break;
+    case 3:
+      (reference ? refLine : lcd_line)(op.x, op.y, op.x2, op.y2, op.pat, op.att);
+      break;
+    case 4:
+      (reference ? refImg : lcd_img)(op.x - 10, op.y, refImage, op.idx, op.att & INVERS);
+      break;
+    default:
+      if (reference) {
+        for (int i=op.idx*4*LCD_W; i<(op.idx+1)*4*LCD_W; i++) displayBuf[i] ^= 0xff;
+      }
+      else {
+        lcd_invert_line(op.idx);
+      }
+      break;
+  }
+}
+
+TEST(Lcd, rasterPrimitivesArePixelExact)
+{
+  static uint8_t initial[DISPLAY_BUFER_SIZE];
+  static uint8_t expected[DISPLAY_BUFER_SIZE];
+
+  srand(0x4242);
+  for (int n=0; n<5000; n++) {
+    for (unsigned int i=0; i<DISPLAY_BUFER_SIZE; i++) {
+      initial[i] = rand();
+    }
+
+    RasterOperation op;
+    op.kind = rand() % 6;
+    op.att = refAttributes[rand() % DIM(refAttributes)];
+    op.pat = refPattern(rand());
+    // the former hline didn't clip on the left, the positions are chosen so that it doesn't matter
+    op.x = rand() % (LCD_W + 8);
+    op.y = rand() % (LCD_H + 20) - 10;
+    op.w = rand() % (LCD_W + 10) + 1;
+    op.h = rand() % (LCD_H + 10) - 5;
+    op.x2 = rand() % LCD_W;
+    op.y2 = rand() % LCD_H;
+    op.idx = rand() % 2;
+    if (op.kind == 4 && rand() % 2) op.att |= INVERS;
+
+    memcpy(displayBuf, initial, DISPLAY_BUFER_SIZE);
+    drawRasterOperation(op, true);
+    memcpy(expected, displayBuf, DISPLAY_BUFER_SIZE);
+
+    memcpy(displayBuf, initial, DISPLAY_BUFER_SIZE);
+    drawRasterOperation(op, false);
+    ASSERT_EQ(0, memcmp(expected, displayBuf, DISPLAY_BUFER_SIZE)) << "operation " << op.kind << " at iteration " << n;
+  }
+}
+
+TEST(Lcd, hlineStipClippedOnTheLeft)
+{
+  lcd_clear();
+  lcd_hlineStip(-5, 3, 10, 0x0F, FORCE);
+  // the pattern starts on the first (hidden) pixel, 5 pixels are visible
+  EXPECT_EQ(0x00, displayBuf[LCD_W + 0] & 0xF0);
+  EXPECT_EQ(0xF0, displayBuf[LCD_W + 3] & 0xF0);
+  EXPECT_EQ(0xF0, displayBuf[LCD_W + 4] & 0xF0);
+  EXPECT_EQ(0x00, displayBuf[LCD_W + 5]);
+  // nothing was written at the end of the previous row
+  EXPECT_EQ(0x00, displayBuf[LCD_W - 1]);
+}
+
+TEST(Lcd, bmpClippedOnEachSide)
+{
+  uint8_t bitmap[2 + 10*4] = { 10, 8 };
+  for (int i=2; i<(int)sizeof(bitmap); i++) {
+    bitmap[i] = i * 37;
+  }
+
+  for (int x=-12; x<=LCD_W+2; x+=7) {
+    for (int y=-9; y<=LCD_H+1; y+=3) {
+      memset(displayBuf, 0x5A, DISPLAY_BUFER_SIZE);
+      lcd_bmp(x, y, bitmap);
+      for (int py=0; py<LCD_H; py++) {
+        for (int px=0; px<LCD_W; px++) {
+          int bx = px - x, by = py - y;
+          uint8_t pixel = (displayBuf[py/2*LCD_W + px] >> ((py&1)*4)) & 0x0F;
+          if (bx >= 0 && bx < 10 && by >= 0 && by < 8)
+            ASSERT_EQ((bitmap[2 + by/2*10 + bx] >> ((by&1)*4)) & 0x0F, pixel) << x << "," << y;
+          else
+            ASSERT_EQ((py&1) ? 0x5 : 0xA, pixel) << x << "," << y;
+        }
+      }
+    }
+  }
+}
+#endif
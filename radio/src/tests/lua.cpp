@@ -35,6 +35,7 @@
  */
 
 #include <math.h>
+#include <sys/stat.h>
 #include "gtests.h"
 
 #if defined(LUA)
@@ -182,4 +183,187 @@ TEST(Lua, testModelInputs)
 
 }
 
+TEST(Lua, testGetFieldInfo)
+{
+  char script[100];
+  MODEL_RESET();
+  // first, middle and last entries of the sorted fields list
+  luaExecStr("if getFieldInfo('ail').id ~= MIXSRC_Ail then error('ail') end");
+  luaExecStr("if getFieldInfo('thr').id ~= MIXSRC_Thr then error('thr') end");
+  sprintf(script, "if getFieldInfo('tx-voltage').id ~= %d then error('tx-voltage') end", MIXSRC_TX_VOLTAGE);
+  luaExecStr(script);
+  luaExecStr("if getFieldInfo('a') or getFieldInfo('zzz') or getFieldInfo('') then error('not found') end");
+  // multiple fields
+  luaExecStr("if getFieldInfo('ch1').id ~= MIXSRC_CH1 then error('ch1') end");
+  sprintf(script, "if getFieldInfo('ls12').id ~= %d then error('ls12') end", MIXSRC_SW1+11);
+  luaExecStr(script);
+  sprintf(script, "if getFieldInfo('ls').id ~= %d then error('ls') end", MIXSRC_SLIDER1);
+  luaExecStr(script);
+}
+
+TEST(Lua, testGetValueMultiple)
+{
+  MODEL_RESET();
+  luaExecStr("if select('#', getValue('ail', MIXSRC_Ele, 'unknown')) ~= 3 then error('count') end");
+  luaExecStr("a, b, c = getValue('ail', MIXSRC_Ele, 'unknown')");
+  luaExecStr("if a ~= getValue(MIXSRC_Ail) or b ~= getValue('ele') or c ~= 0 then error('values') end");
+}
+
+void writeMixScript(const char * name, const char * source)
+{
+  extern char simuSdDirectory[1024];
+  char path[1100];
+  sprintf(path, "%s/SCRIPTS", simuSdDirectory);
+  mkdir(path, 0777);
+  strcat(path, "/MIXES");
+  mkdir(path, 0777);
+  sprintf(path + strlen(path), "/%s.lua", name);
+  FILE * f = fopen(path, "w");
+  fputs(source, f);
+  fclose(f);
+}
+
+TEST(Lua, testMixScriptSuspendedAndResumed)
+{
+  extern char simuSdDirectory[1024];
+  char directory[] = "/tmp/luatestXXXXXX";
+  char savedDirectory[1024];
+  strcpy(savedDirectory, simuSdDirectory);
+  ASSERT_TRUE(mkdtemp(directory) != NULL);
+  strcpy(simuSdDirectory, directory);
+
+  // a run of about 3 slices, then a run which never ends
+  writeMixScript("slow", "local n = 0\n"
+                         "local function run() for i=1,10000 do n = n + 1 end return n end\n"
+                         "return { output={ 'out' }, run=run }\n");
+  writeMixScript("loop", "local function run() while true do end end\n"
+                         "return { output={ 'out' }, run=run }\n");
+
+  MODEL_RESET();
+  strncpy(g_model.scriptsData[0].file, "slow", sizeof(g_model.scriptsData[0].file));
+  strncpy(g_model.scriptsData[1].file, "loop", sizeof(g_model.scriptsData[1].file));
+  luaState = INTERPRETER_RELOAD_PERMANENT_SCRIPTS;
+
+  int passes = 0;
+  do {
+    luaTask(0, RUN_MIX_SCRIPT, false);
+    passes++;
+  } while (scriptInputsOutputs[0].outputs[0].value == 0 && passes < 10);
+  EXPECT_EQ(scriptInternalData[0].state, SCRIPT_OK);
+  EXPECT_EQ(scriptInputsOutputs[0].outputs[0].value, 10000);
+  EXPECT_GT(passes, 1);
+
+  // the next run starts from the first slice again
+  luaTask(0, RUN_MIX_SCRIPT, false);
+  EXPECT_EQ(scriptInputsOutputs[0].outputs[0].value, 10000);
+  while (scriptInputsOutputs[0].outputs[0].value == 10000 && passes < 20) {
+    luaTask(0, RUN_MIX_SCRIPT, false);
+    passes++;
+  }
+  EXPECT_EQ(scriptInputsOutputs[0].outputs[0].value, 20000);
+
+  // the endless script is suspended on each pass, then killed
+  EXPECT_EQ(scriptInternalData[1].state, SCRIPT_OK);
+  for (int i=0; i<100; i++) {
+    luaTask(0, RUN_MIX_SCRIPT, false);
+  }
+  EXPECT_EQ(scriptInternalData[1].state, SCRIPT_KILLED);
+  EXPECT_EQ(scriptInternalData[0].state, SCRIPT_OK);
+
+  memset(g_model.scriptsData, 0, sizeof(g_model.scriptsData));
+  luaState = INTERPRETER_RELOAD_PERMANENT_SCRIPTS;
+  luaTask(0, RUN_MIX_SCRIPT, false);
+  strcpy(simuSdDirectory, savedDirectory);
+
+  char path[100];
+  sprintf(path, "%s/SCRIPTS/MIXES/slow.lua", directory);
+  remove(path);
+  sprintf(path, "%s/SCRIPTS/MIXES/loop.lua", directory);
+  remove(path);
+  sprintf(path, "%s/SCRIPTS/MIXES", directory);
+  rmdir(path);
+  sprintf(path, "%s/SCRIPTS", directory);
+  rmdir(path);
+  rmdir(directory);
+}
+
+static uint8_t lcdPixel(int x, int y)
+{
+  return (displayBuf[y/2*LCD_W+x] >> ((y&1)*4)) & 0x0F;
+}
+
+TEST(Lua, testLcdBatchedDrawing)
+{
+  static uint8_t expected[DISPLAY_BUFER_SIZE];
+  luaLcdAllowed = true;
+
+  // a polyline gives the same pixels as its separate lines
+  lcd_clear();
+  luaExecStr("lcd.drawLine(10, 10, 50, 30, SOLID, 0) lcd.drawLine(50, 30, 80, 5, SOLID, 0) lcd.drawLine(80, 5, 81, 60, SOLID, 0)");
+  memcpy(expected, displayBuf, DISPLAY_BUFER_SIZE);
+  lcd_clear();
+  luaExecStr("lcd.drawPolyline({10, 10, 50, 30, 80, 5, 81, 60})");
+  EXPECT_EQ(0, memcmp(expected, displayBuf, DISPLAY_BUFER_SIZE));
+
+  // the history starts with the oldest value of the ring buffer
+  lcd_clear();
+  luaExecStr("lcd.drawLine(100, 6, 110, 4, SOLID, 0) lcd.drawLine(110, 4, 120, 10, SOLID, 0) lcd.drawLine(120, 10, 130, 8, SOLID, 0)");
+  memcpy(expected, displayBuf, DISPLAY_BUFER_SIZE);
+  lcd_clear();
+  luaExecStr("lcd.drawHistory(100, 0, 31, 11, {2, 4, 6, 0}, 2, 0, 10)");
+  EXPECT_EQ(0, memcmp(expected, displayBuf, DISPLAY_BUFER_SIZE));
+
+  // 5 bars of 4 pixels, the values are limited to the area
+  lcd_clear();
+  luaExecStr("lcd.drawBars(0, 40, 20, 10, {0, 5, 10, 20, -3}, 0, 10)");
+  EXPECT_EQ(0, lcdPixel(0, 49));
+  EXPECT_NE(0, lcdPixel(4, 49));
+  EXPECT_NE(0, lcdPixel(6, 45));
+  EXPECT_EQ(0, lcdPixel(6, 44));
+  EXPECT_EQ(0, lcdPixel(7, 49));
+  EXPECT_NE(0, lcdPixel(8, 40));
+  EXPECT_NE(0, lcdPixel(14, 40));
+  EXPECT_EQ(0, lcdPixel(12, 39));
+  EXPECT_EQ(0, lcdPixel(16, 49));
+
+  luaLcdAllowed = false;
+}
+
+TEST(Lua, testMixScriptKilledInsideCFunction)
+{
+  extern char simuSdDirectory[1024];
+  char directory[] = "/tmp/luatestXXXXXX";
+  char savedDirectory[1024];
+  strcpy(savedDirectory, simuSdDirectory);
+  ASSERT_TRUE(mkdtemp(directory) != NULL);
+  strcpy(simuSdDirectory, directory);
+
+  // the run can't be suspended while inside pcall()
+  writeMixScript("pcall", "local function loop() for i=1,100000 do end end\n"
+                          "local function run() pcall(loop) return 1 end\n"
+                          "return { output={ 'out' }, run=run }\n");
+
+  MODEL_RESET();
+  strncpy(g_model.scriptsData[0].file, "pcall", sizeof(g_model.scriptsData[0].file));
+  luaState = INTERPRETER_RELOAD_PERMANENT_SCRIPTS;
+  luaTask(0, RUN_MIX_SCRIPT, false);
+  luaTask(0, RUN_MIX_SCRIPT, false);
+  EXPECT_EQ(scriptInternalData[0].state, SCRIPT_KILLED);
+  EXPECT_EQ(scriptInputsOutputs[0].outputs[0].value, 0);
+
+  memset(g_model.scriptsData, 0, sizeof(g_model.scriptsData));
+  luaState = INTERPRETER_RELOAD_PERMANENT_SCRIPTS;
+  luaTask(0, RUN_MIX_SCRIPT, false);
+  strcpy(simuSdDirectory, savedDirectory);
+
+  char path[100];
+  sprintf(path, "%s/SCRIPTS/MIXES/pcall.lua", directory);
+  remove(path);
+  sprintf(path, "%s/SCRIPTS/MIXES", directory);
+  rmdir(path);
+  sprintf(path, "%s/SCRIPTS", directory);
+  rmdir(path);
+  rmdir(directory);
+}
+
 #endif   // #if defined(LUA)
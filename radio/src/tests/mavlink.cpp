@@ -0,0 +1,148 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include "gtests.h"
+
+#if defined(MAVLINK)
+static void sendBytes(const uint8_t * data, int len)
+{
+  for (int i=0; i<len; i++) {
+    RXHandler(data[i]);
+  }
+}
+
+static uint16_t buildVfrHud(uint8_t * buffer, int16_t heading)
+{
+  mavlink_message_t msg;
+  mavlink_msg_vfr_hud_pack(1, 1, &msg, 0, 0, heading, 0, heading/10.0f, 0);
+  return mavlink_msg_to_send_buffer(buffer, &msg);
+}
+
+static void sendNoise(int len, bool withStx)
+{
+  for (int i=0; i<len; i++) {
+    uint8_t byte = rand();
+    if (byte == MAVLINK_STX && !withStx)
+      byte = 0;
+    RXHandler(byte);
+  }
+}
+
+TEST(Mavlink, messagesAmongNoise)
+{
+  uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+  g_tmr10ms = 1;
+  srand(42);
+
+  for (int i=0; i<500; i++) {
+    sendNoise(rand() % 64, false);
+    uint16_t len = buildVfrHud(frame, i);
+    sendBytes(frame, len);
+    telemetryWakeup();
+    EXPECT_EQ(i, telemetry_data.heading);
+    EXPECT_EQ(i/10.0f, telemetry_data.loc_current.rel_alt);
+  }
+}
+
+TEST(Mavlink, corruptedAndTruncatedMessages)
+{
+  uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+  g_tmr10ms = 1;
+  srand(7);
+
+  for (int i=1; i<200; i++) {
+    uint16_t len = buildVfrHud(frame, 1000+i);
+    if (i & 1) {
+      // a payload or checksum byte is changed
+      frame[6 + rand() % (len-6)] ^= 1 + rand() % 255;
+      sendBytes(frame, len);
+    }
+    else {
+      // the frame is cut, then the payload of the next one fills it
+      sendBytes(frame, 6 + rand() % (len-8));
+      sendNoise(MAVLINK_MAX_PACKET_LEN, false);
+      telemetryWakeup();
+    }
+    len = buildVfrHud(frame, i);
+    sendBytes(frame, len);
+    telemetryWakeup();
+    EXPECT_EQ(i, telemetry_data.heading);
+  }
+}
+
+TEST(Mavlink, fifoOverflow)
+{
+  uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+  g_tmr10ms = 1;
+  srand(99);
+
+  for (int i=1; i<50; i++) {
+    // the fifo is full in the middle of a frame, its end is dropped
+    uint16_t len = buildVfrHud(frame, i);
+    sendNoise(255 - len/2, false);
+    sendBytes(frame, len);
+    telemetryWakeup();
+    EXPECT_NE(i, telemetry_data.heading);
+
+    // the parser waits for the next frame
+    len = buildVfrHud(frame, 100+i);
+    sendBytes(frame, len);
+    telemetryWakeup();
+    EXPECT_EQ(100+i, telemetry_data.heading);
+  }
+}
+
+TEST(Mavlink, randomStream)
+{
+  uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+  g_tmr10ms = 1;
+  srand(1234);
+
+  for (int i=0; i<1000; i++) {
+    sendNoise(1 + rand() % 255, true);
+    telemetryWakeup();
+  }
+
+  // the parser is back in sync once the last frame started in the noise is over
+  sendNoise(MAVLINK_MAX_PACKET_LEN, false);
+  telemetryWakeup();
+  uint16_t len = buildVfrHud(frame, 321);
+  sendBytes(frame, len);
+  telemetryWakeup();
+  EXPECT_EQ(321, telemetry_data.heading);
+}
+#endif
@@ -401,6 +401,31 @@ TEST(Trims, CopySticksToOffset)
   EXPECT_EQ(g_model.limitData[1].offset, -97);
 }
 
+#if defined(CPUARM) && defined(OVERRIDE_CHANNEL_FUNCTION)
+TEST(SpecialFunctions, FunctionAddedAndRemoved)
+{
+  MODEL_RESET();
+  modelDefault(0);
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(safetyCh[0], OVERRIDE_CHANNEL_UNDEFINED);
+
+  CustomFunctionData * cfn = &g_model.customFn[NUM_CFN-1];
+  CFN_SWITCH(cfn) = SWSRC_ON;
+  CFN_FUNC(cfn) = FUNC_OVERRIDE_CHANNEL;
+  CFN_CH_INDEX(cfn) = 0;
+  CFN_PARAM(cfn) = 50;
+  CFN_ACTIVE(cfn) = 1;
+  eeDirty(EE_MODEL);
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(safetyCh[0], 50);
+
+  CFN_SWITCH(cfn) = SWSRC_NONE;
+  eeDirty(EE_MODEL);
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(safetyCh[0], OVERRIDE_CHANNEL_UNDEFINED);
+}
+#endif
+
 TEST(Trims, InstantTrim)
 {
   MODEL_RESET();
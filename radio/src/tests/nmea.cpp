@@ -0,0 +1,103 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include "gtests.h"
+
+#if defined(NMEA)
+extern char rbuf[][14];
+extern char sbuf[];
+extern uint8_t ggareceived;
+void initval(uint8_t num, uint8_t pack, uint8_t val);
+
+void sendSentence(const char * body, bool corrupted=false)
+{
+  uint8_t checksum = 0;
+  for (const char * c=body; *c; c++)
+    checksum ^= *c;
+  if (corrupted)
+    checksum ^= 0x01;
+  char buffer[100];
+  sprintf(buffer, "$%s*%02X\r\n", body, checksum);
+  for (const char * c=buffer; *c; c++)
+    NMEA_parse(*c);
+}
+
+void resetNmea()
+{
+  memset(rbuf, 0, 3*14);
+  memset(sbuf, 0, 3);
+  ggareceived = 0;
+  initval(0, 'G', 9);           // GGA altitude
+  initval(1, 'G', 1);           // GGA time
+  initval(5, 'G', 7);           // GGA number of satellites
+}
+
+TEST(Nmea, validSentence)
+{
+  resetNmea();
+  sendSentence("GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+  EXPECT_STREQ(rbuf[0], "545.4");
+  EXPECT_STREQ(rbuf[1], "123519");
+  EXPECT_EQ(sbuf[2], '8');
+  EXPECT_EQ(ggareceived, 1);
+}
+
+TEST(Nmea, corruptedSentence)
+{
+  resetNmea();
+  sendSentence("GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+  ggareceived = 0;
+  sendSentence("GPGGA,123520,4807.038,N,01131.000,E,1,09,0.9,546.4,M,46.9,M,,", true);
+  EXPECT_STREQ(rbuf[0], "545.4");
+  EXPECT_STREQ(rbuf[1], "123519");
+  EXPECT_EQ(sbuf[2], '8');
+  EXPECT_EQ(ggareceived, 0);
+}
+
+TEST(Nmea, resyncAfterTruncatedSentence)
+{
+  resetNmea();
+  const char * truncated = "$GPGGA,123519,4807.0";
+  for (const char * c=truncated; *c; c++)
+    NMEA_parse(*c);
+  sendSentence("GPGGA,123521,4807.038,N,01131.000,E,1,07,0.9,,M,46.9,M,,");
+  EXPECT_STREQ(rbuf[0], "");    // empty field, the value is kept
+  EXPECT_STREQ(rbuf[1], "123521");
+  EXPECT_EQ(sbuf[2], '7');
+  EXPECT_EQ(ggareceived, 1);
+}
+#endif
@@ -0,0 +1,217 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "gtests.h"
+
+#if defined(CPUARM)
+// The PXX encoder as it was before the stuffing table, one bit at a time
+class PxxReferenceEncoder
+{
+  public:
+    PxxReferenceEncoder():
+      ptr(pulses),
+      pcmValue(0),
+      pcmCrc(0),
+      pcmOnesCount(0),
+      serialByte(0),
+      serialBitCount(0)
+    {
+    }
+
+    void putCrc(uint8_t data)
+    {
+      uint16_t value = (pcmCrc >> 8) ^ data;
+      for (int i=0; i<8; i++) {
+        value = (value & 1) ? (value >> 1) ^ 0x8408 : (value >> 1);
+      }
+      pcmCrc = (pcmCrc << 8) ^ value;
+    }
+
+#if defined(PCBTARANIS)
+    void putPart(uint8_t value)
+    {
+      pcmValue += 18;
+      *ptr++ = pcmValue;
+      pcmValue += 14;
+      if (value) {
+        pcmValue += 16;
+      }
+      *ptr++ = pcmValue;
+    }
+
+    void putFlush()
+    {
+      *ptr++ = 18010;
+    }
+#else
+    void putSerialBit(uint8_t bit)
+    {
+      serialByte >>= 1;
+      if (bit & 1) {
+        serialByte |= 0x80;
+      }
+      if (++serialBitCount >= 8) {
+        *ptr++ = serialByte;
+        serialBitCount = 0;
+      }
+    }
+
+    void putPart(uint8_t value)
+    {
+      putSerialBit(0);
+      if (value) {
+        putSerialBit(0);
+      }
+      putSerialBit(1);
+    }
+
+    void putFlush()
+    {
+      while (serialBitCount != 0) {
+        putSerialBit(1);
+      }
+    }
+#endif
+
+    void putBit(uint8_t bit)
+    {
+      if (bit) {
+        pcmOnesCount += 1;
+        putPart(1);
+      }
+      else {
+        pcmOnesCount = 0;
+        putPart(0);
+      }
+      if (pcmOnesCount >= 5) {
+        putBit(0);
+      }
+    }
+
+    void putByte(uint8_t byte)
+    {
+      putCrc(byte);
+      for (int i=0; i<8; i++) {
+        putBit(byte & 0x80);
+        byte <<= 1;
+      }
+    }
+
+    void putHead()
+    {
+      putPart(0);
+      for (int i=0; i<6; i++) {
+        putPart(1);
+      }
+      putPart(0);
+    }
+
+    // channels are the 8 values sent in the frame, in the 1..2046 range
+    void putFrame(uint8_t rxNumber, uint8_t flag1, const uint16_t * channels)
+    {
+      for (int i=0; i<4; i++) {
+        putPart(0);
+      }
+      putHead();
+      putByte(rxNumber);
+      putByte(flag1);
+      putByte(0);
+      for (int i=0; i<8; i+=2) {
+        putByte(channels[i]);
+        putByte(((channels[i] >> 8) & 0x0F) | (channels[i+1] << 4));
+        putByte(channels[i+1] >> 4);
+      }
+      putByte(0);
+      uint16_t crc = pcmCrc;
+      putByte(crc >> 8);
+      putByte(crc);
+      putHead();
+      putFlush();
+    }
+
+    void check(unsigned int port)
+    {
+      const PxxPulsesData & pxx = modulePulsesData[port].pxx;
+      ASSERT_EQ(ptr - pulses, pxx.ptr - pxx.pulses);
+      for (int i=0; i<ptr-pulses; i++) {
+        EXPECT_EQ(pulses[i], pxx.pulses[i]) << "pulse " << i;
+      }
+    }
+
+  protected:
+#if defined(PCBTARANIS)
+    uint16_t pulses[400];
+    uint16_t * ptr;
+#else
+    uint8_t pulses[64];
+    uint8_t * ptr;
+#endif
+    uint16_t pcmValue;
+    uint16_t pcmCrc;
+    uint32_t pcmOnesCount;
+    uint16_t serialByte;
+    uint16_t serialBitCount;
+};
+
+TEST(Pxx, sameFramesAsBitEncoder)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+  g_model.moduleData[EXTERNAL_MODULE].type = MODULE_TYPE_XJT;
+  g_model.moduleData[EXTERNAL_MODULE].rfProtocol = RF_PROTO_D8;
+  resetPulsesPXX(EXTERNAL_MODULE);
+
+  srand(0x5A5A);
+  for (int frame=0; frame<200; frame++) {
+    // the rx number changes every 50 frames, the cached frame start has to follow it
+    g_model.header.modelId[EXTERNAL_MODULE] = (frame / 50) * 31;
+
+    uint16_t channels[8];
+    for (int i=0; i<8; i++) {
+      // the extremes give long runs of 1s which need stuffing
+      int r = rand() % 4;
+      channelOutputs[i] = (r == 0 ? 1024 : (r == 1 ? -1024 : (rand() % 2049) - 1024));
+      channels[i] = limit(1, (channelOutputs[i] * 512 / 682) + 1024, 2046);
+    }
+
+    setupPulsesPXX(EXTERNAL_MODULE);
+
+    PxxReferenceEncoder reference;
+    reference.putFrame(g_model.header.modelId[EXTERNAL_MODULE], RF_PROTO_D8 << 6, channels);
+    reference.check(EXTERNAL_MODULE);
+  }
+}
+#endif
@@ -253,3 +253,16 @@ TEST(Timers, timerThrottleTriggered)
   EXPECT_TRUE(evalTimersForNSecondsAndTest(10,         0, 0, TMR_NEGATIVE,-11));
   EXPECT_TRUE(evalTimersForNSecondsAndTest(100,        0, 0, TMR_STOPPED,-111));
 }
+
+TEST(Timers, timerAtLimitDoesntStopTheOthers)
+{
+  initModelTimer(0, TMRMODE_ABS, 0);
+  timerSet(0, TIMER_MAX);
+  g_model.timers[1] = g_model.timers[0];
+  timerReset(1);
+
+  EXPECT_TRUE(evalTimersForNSecondsAndTest(10, THR_100, 0, TMR_RUNNING, TIMER_MAX));
+  EXPECT_TRUE(evalTimersForNSecondsAndTest(0,  THR_100, 1, TMR_RUNNING, 10));
+
+  g_model.timers[1].mode = TMRMODE_NONE;
+}
@@ -435,6 +435,7 @@ void SCSI_SenseCode(uint8_t lun, uint8_t sKey, uint8_t ASC)
 */
 
 extern uint8_t lunReady[] ;
+extern void STORAGE_Eject(uint8_t lun) ;
 
 static int8_t SCSI_StartStopUnit(uint8_t lun, uint8_t *params)
 {
@@ -454,6 +455,7 @@ static int8_t SCSI_StartStopUnit(uint8_t lun, uint8_t *params)
     else {
       // lun to be ejected
       lunReady[lun] = 0 ;
+      STORAGE_Eject(lun) ;
     }
   }
 
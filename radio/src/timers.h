@@ -55,8 +55,7 @@ typedef uint16_t tmrstart_t;
 #define TIMER_MIN     (-TIMER_MAX-1)
 
 struct TimerState {
-  uint16_t cnt;
-  uint16_t sum;
+  uint16_t sum;   // throttle integrated over time for TMRMODE_THR_REL
   uint8_t  state;
   tmrval_t  val;
   uint8_t  val_10ms;